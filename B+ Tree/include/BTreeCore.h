@@ -0,0 +1,1190 @@
+#ifndef _B_TREE_CORE_H_
+#define _B_TREE_CORE_H_
+
+#include "BTreeHeaderPage.h"
+#include "BTreeInclude.h"
+#include "db.h"
+#include "bufmgr.h"
+#include "system_defs.h"
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+//-------------------------------------------------------------------
+// BTreeCore
+//
+// The tree algorithms shared by BTreeFile and IntBTreeFile: inserts with
+// splits, batch inserts, bulk loading, deletes with merges and
+// redistribution, and destroying the index. The core only descends, pins,
+// allocates and links pages. Everything that depends on how a page stores
+// its keys comes from Traits:
+//
+//   KeyArg                 - a key as it is passed in
+//   Key                    - a buffer that holds a copy of one key
+//   IndexPageType, LeafPageType, SourceType
+//                          - the page types, and the BulkLoad input
+//
+// and static functions that compare and copy keys, pick children, split,
+// merge and redistribute pages, and tell when a page is filled or
+// underflows. StringKeyTraits (BTreeFile.h) and IntKeyTraits
+// (IntBTreeFile.h) document each of them.
+//
+// Both page types provide Insert, InsertAfter, Delete and Contains with the
+// same meaning, which the core calls directly.
+//-------------------------------------------------------------------
+template<typename Traits>
+class BTreeCore {
+
+public:
+	typedef typename Traits::KeyArg KeyArg;
+	typedef typename Traits::Key Key;
+	typedef typename Traits::IndexPageType IndexPageType;
+	typedef typename Traits::LeafPageType LeafPageType;
+	typedef typename Traits::SourceType SourceType;
+
+	//-------------------------------------------------------------------
+	// BTreeCore::BTreeCore
+	//
+	// Input   : filename - filename of an index.
+	//           keyType - the HEADER_KEY_* type of the keys in the index
+	//           prefixCompressLeaves - whether leaf pages of a new index
+	//                                  store one common key prefix per page
+	// Output  : returnStatus - OK if successful, FAIL otherwise. An existing
+	//                          index with another key type can't be opened,
+	//                          and its header is left unpinned.
+	// Purpose : Opens the index file if it exists, and creates it otherwise.
+	//           The header page stays pinned until the index is closed.
+	//-------------------------------------------------------------------
+	BTreeCore(Status& returnStatus, const char *filename, int keyType, bool prefixCompressLeaves) {
+		PageID headerID = INVALID_PAGE;
+		header = NULL;
+		dbfile = filename;
+
+		Status s = MINIBASE_DB->GetFileEntry(filename, headerID);
+		if (s == FAIL) { // no database header page yet, create it, pinned by NewPage
+			returnStatus = MINIBASE_BM->NewPage(headerID, (Page*&) header);
+			if (returnStatus != OK) {
+				std::cout << "Unable to allocate header page for index " << filename << std::endl;
+				header = NULL;
+				return;
+			}
+			header->Init(headerID);
+			header->SetLeafPrefixCompression(prefixCompressLeaves);
+			header->SetKeyType(keyType);
+			returnStatus = MINIBASE_DB->AddFileEntry(filename, headerID);
+			if (returnStatus != OK) {
+				MINIBASE_BM->UnpinPage(headerID, CLEAN);
+				MINIBASE_BM->FreePage(headerID);
+				header = NULL;
+			}
+			return;
+		}
+
+		returnStatus = MINIBASE_BM->PinPage(headerID, (Page*&) header); // pin the header
+		if (returnStatus != OK) {
+			std::cout << "Unable to pin header page of index " << filename << std::endl;
+			header = NULL;
+		}
+		else if (header->GetKeyType() != keyType) {
+			// the pages hold keys of another type, which can't be read
+			std::cout << "Index " << filename << " was built with another key type" << std::endl;
+			MINIBASE_BM->UnpinPage(headerID, CLEAN);
+			header = NULL;
+			returnStatus = FAIL;
+		}
+	}
+
+
+	//-------------------------------------------------------------------
+	// BTreeCore::~BTreeCore
+	//
+	// Purpose : Unpins the header page, if the constructor pinned it.
+	//-------------------------------------------------------------------
+	~BTreeCore() {
+		if (header != NULL) {
+			MINIBASE_BM->UnpinPage(((HeapPage*) header)->PageNo(), true);
+		}
+	}
+
+
+	//-------------------------------------------------------------------
+	// BTreeCore::DestroyFile
+	//
+	// Input   : None
+	// Output  : None
+	// Return  : OK if successful, FAIL otherwise.
+	// Purpose : Free all pages and delete the entire index file.
+	//-------------------------------------------------------------------
+	Status DestroyFile() {
+		PageID rootPid = header->GetRootPageID();
+		if (rootPid == INVALID_PAGE) { // no root, done deleting already
+			return OK;
+		}
+
+		Status s = DestroyHelper(rootPid);
+		if (s != OK) {
+			std::cout << "First call to destroy helper failed" << std::endl;
+			return s;
+		}
+		header->SetRootPageID(INVALID_PAGE);
+		return MINIBASE_DB->DeleteFileEntry(dbfile);
+	}
+
+
+	//-------------------------------------------------------------------
+	// BTreeCore::Insert
+	//
+	// Input   : key - the key to be inserted.
+	//           rid - RecordID of the record to be inserted.
+	// Output  : None
+	// Return  : OK if successful, FAIL otherwise.
+	// Purpose : Insert an index entry with this rid and key.
+	// Note    : If the root didn't exist, create it. If the root splits, a
+	//           new root is put above it.
+	//-------------------------------------------------------------------
+	Status Insert(KeyArg key, const RecordID rid) {
+		PageID rootPid = header->GetRootPageID();
+
+		if (rootPid == INVALID_PAGE) {
+			LeafPageType* leafPage;
+			NEWPAGE(rootPid, leafPage);
+			Traits::InitLeaf(leafPage, rootPid, header);
+			leafPage->SetNextPage(INVALID_PAGE);
+			leafPage->SetPrevPage(INVALID_PAGE);
+			UNPIN(rootPid, DIRTY);
+			header->SetRootPageID(rootPid);
+		}
+
+		bool split;
+		Key newChildKey;
+		PageID newChildPid;
+		Status s = InsertHelper(rootPid, key, rid, split, newChildKey, newChildPid);
+		if (s != OK || !split) {
+			return s;
+		}
+
+		// the old root is the leftmost child of the new one
+		IndexPageType* newRoot;
+		PageID newRootPid;
+		PageGuard rootGuard;
+		NEWPAGE_GUARD(rootGuard, newRootPid, newRoot);
+		newRoot->Init(newRootPid, INDEX_PAGE);
+		newRoot->SetNextPage(INVALID_PAGE);
+		newRoot->SetPrevPage(rootPid);
+		s = newRoot->Insert(newChildKey, newChildPid);
+		if (s != OK) {
+			std::cout << "Error inserting into new root" << std::endl;
+			return s;
+		}
+
+		header->SetRootPageID(newRootPid);
+		return OK;
+	}
+
+
+	//-------------------------------------------------------------------
+	// BTreeCore::InsertBatch
+	//
+	// Input   : keys, rids - the pairs to insert, in any order
+	//           numPairs - the number of pairs
+	// Output  : None
+	// Return  : OK if successful, FAIL otherwise.
+	// Purpose : Inserts many pairs with shared descents. The pairs are sorted
+	//           and pushed down the tree together, so every page on the way
+	//           is pinned once per batch instead of once per key. Pages split
+	//           by the batch are collected and added to their parent together.
+	//-------------------------------------------------------------------
+	Status InsertBatch(const KeyArg *keys, const RecordID *rids, int numPairs) {
+		if (numPairs <= 0) {
+			return OK;
+		}
+
+		std::vector<BatchEntry> entries(numPairs);
+		for (int i = 0; i < numPairs; i++) {
+			entries[i].key = keys[i];
+			entries[i].rid = rids[i];
+		}
+		// stable, so values of a key keep the order they were given in
+		std::stable_sort(entries.begin(), entries.end(), BatchEntryLess);
+
+		PageID rootPid = header->GetRootPageID();
+
+		if (rootPid == INVALID_PAGE) {
+			LeafPageType* leafPage;
+			PageGuard rootGuard;
+			NEWPAGE_GUARD(rootGuard, rootPid, leafPage);
+			Traits::InitLeaf(leafPage, rootPid, header);
+			leafPage->SetNextPage(INVALID_PAGE);
+			leafPage->SetPrevPage(INVALID_PAGE);
+			header->SetRootPageID(rootPid);
+		}
+
+		std::vector<SplitEntry> newSiblings;
+		Status s = InsertBatchHelper(rootPid, &entries[0], numPairs, newSiblings);
+
+		// the root split, so grow the tree until the new root has room for them
+		// all. This is done even if the batch failed part way, so that pages
+		// split off before the failure stay reachable.
+		while (!newSiblings.empty()) {
+			IndexPageType* newRoot;
+			PageID newRootPid;
+			PageGuard rootGuard;
+			NEWPAGE_GUARD(rootGuard, newRootPid, newRoot);
+			newRoot->Init(newRootPid, INDEX_PAGE);
+			newRoot->SetNextPage(INVALID_PAGE);
+			newRoot->SetPrevPage(rootPid);
+
+			std::vector<SplitEntry> children;
+			children.swap(newSiblings);
+			Status rootStatus = InsertBatchIntoIndex(rootGuard, newRoot, children, newSiblings);
+			if (s == OK) {
+				s = rootStatus;
+			}
+
+			rootPid = newRootPid;
+			header->SetRootPageID(rootPid);
+		}
+
+		return s;
+	}
+
+
+	//-------------------------------------------------------------------
+	// BTreeCore::BulkLoad
+	//
+	// Input   : source - the (key, rid) pairs to load, in ascending key order
+	//           fillFactor - fraction of each page to fill, in (0, 1]. Values
+	//                        below 1 leave room for later inserts.
+	// Output  : None
+	// Return  : OK if successful, FAIL otherwise.
+	// Purpose : Builds the index in one sequential pass. Leaves are filled left
+	//           to right and linked as they are written, and each new page's
+	//           separator is appended to the rightmost index page of the level
+	//           above, so index levels grow bottom up as they fill.
+	// Note    : The index must be empty. Values of a key are kept on one leaf
+	//           past the fill factor as long as they fit. If loading fails,
+	//           the pages written so far are freed and the index stays empty.
+	//           The rightmost page of each level stays pinned from one input
+	//           pair to the next, so these pins are not held by PageGuards;
+	//           once the first leaf is allocated, every exit goes through
+	//           the unpin loop at the end instead.
+	//-------------------------------------------------------------------
+	Status BulkLoad(SourceType& source, double fillFactor = 1.0) {
+		if (header->GetRootPageID() != INVALID_PAGE) {
+			std::cout << "BulkLoad requires an empty index" << std::endl;
+			return FAIL;
+		}
+		if (fillFactor <= 0 || fillFactor > 1) {
+			std::cout << "BulkLoad fill factor must be in (0, 1]" << std::endl;
+			return FAIL;
+		}
+
+		KeyArg key;
+		RecordID rid;
+		Status s = source.GetNext(key, rid);
+		if (s == DONE) {
+			return OK; // nothing to load
+		} else if (s != OK) {
+			return s;
+		}
+
+		LeafPageType* leafPage;
+		PageID leafPid;
+		NEWPAGE(leafPid, leafPage);
+		Traits::InitLeaf(leafPage, leafPid, header);
+		leafPage->SetNextPage(INVALID_PAGE);
+		leafPage->SetPrevPage(INVALID_PAGE);
+
+		std::vector<IndexPageType*> levels; // rightmost index page of each level, bottom up
+		std::vector<PageID> firstPids;      // leftmost page of each level, leaves first
+		firstPids.push_back(leafPid);
+		Key lastKey;
+		bool first = true;
+
+		while (s == OK) {
+			if (!Traits::KeyFits(key)) {
+				std::cout << "Key too long in BulkLoad: " << key << std::endl;
+				s = FAIL;
+				break;
+			}
+
+			int cmp = first ? 1 : Traits::Compare(key, lastKey);
+			if (cmp < 0) {
+				std::cout << "BulkLoad input is not sorted at key " << key << std::endl;
+				s = FAIL;
+				break;
+			}
+
+			bool filled = (cmp != 0 && Traits::PageFilled(leafPage, fillFactor));
+			if (filled || leafPage->Insert(key, rid) != OK) {
+
+				// start the next leaf and link it after the current one
+				LeafPageType* newLeafPage;
+				PageID newLeafPid;
+				s = MINIBASE_BM->NewPage(newLeafPid, (Page*&)newLeafPage);
+				if (s != OK) {
+					std::cout << "Error allocating new leaf page in BulkLoad" << std::endl;
+					break;
+				}
+				Traits::InitLeaf(newLeafPage, newLeafPid, header);
+				newLeafPage->SetNextPage(INVALID_PAGE);
+				newLeafPage->SetPrevPage(leafPid);
+				leafPage->SetNextPage(newLeafPid);
+
+				PageID oldLeafPid = leafPid;
+				leafPage = newLeafPage;
+				leafPid = newLeafPid;
+				s = MINIBASE_BM->UnpinPage(oldLeafPid, DIRTY);
+				if (s != OK) {
+					break;
+				}
+
+				Key separator;
+				Traits::Separator(lastKey, key, separator);
+				s = BulkLoadAddChild(levels, 0, separator, oldLeafPid, newLeafPid, fillFactor);
+				if (levels.size() >= firstPids.size()) {
+					// a new level starts with its only page
+					firstPids.push_back(levels.back()->PageNo());
+				}
+				if (s != OK) {
+					break;
+				}
+
+				s = leafPage->Insert(key, rid);
+				if (s != OK) {
+					std::cout << "Insert into empty leaf failed in BulkLoad" << std::endl;
+					break;
+				}
+			}
+
+			Traits::CopyKey(lastKey, key);
+			first = false;
+			s = source.GetNext(key, rid);
+		}
+
+		bool loaded = (s == DONE);
+		PageID rootPid = levels.empty() ? leafPid : levels.back()->PageNo();
+
+		// unpin every level, even if one of them fails
+		if (MINIBASE_BM->UnpinPage(leafPid, DIRTY) != OK) {
+			loaded = false;
+		}
+		for (unsigned int i = 0; i < levels.size(); i++) {
+			if (MINIBASE_BM->UnpinPage(levels[i]->PageNo(), DIRTY) != OK) {
+				loaded = false;
+			}
+		}
+
+		if (!loaded) {
+			// every page written is on the nextPage chain of its level
+			for (unsigned int i = 0; i < firstPids.size(); i++) {
+				FreeLevel(firstPids[i]);
+			}
+			return FAIL;
+		}
+
+		header->SetRootPageID(rootPid);
+		return OK;
+	}
+
+
+	//-------------------------------------------------------------------
+	// BTreeCore::Delete
+	//
+	// Input   : key - the key to be deleted.
+	//           rid - RecordID of the entry to be deleted.
+	// Output  : None
+	// Return  : OK if successful, FAIL if the entry is not in the index or
+	//           an error occurred before it was removed. DONE if the entry
+	//           was removed, but a page it left underfull could not be 
+	//           rebalanced, e.g. because no buffer frame was free to pin a
+	//           sibling. The tree is then still valid, only emptier than
+	//           DELETE_MIN_FILL in places, and later deletes rebalance it.
+	// Purpose : Delete an index entry with this rid and key. Pages that
+	//           drop below DELETE_MIN_FILL are merged with or borrow from a
+	//           sibling, and an index root left with a single child is removed.
+	//-------------------------------------------------------------------
+	Status Delete(KeyArg key, const RecordID rid) {
+		PageID rootPid = header->GetRootPageID();
+		if (rootPid == INVALID_PAGE) {
+			return FAIL;
+		}
+
+		bool underflow;
+		Status fixStatus = OK;
+		Status s = DeleteHelper(rootPid, key, rid, underflow, fixStatus);
+		if (s != OK) {
+			return FAIL; // DONE means the entry was not found
+		}
+
+		// merges can leave the root with only its leftmost child, which then
+		// becomes the new root
+		while (true) {
+			IndexPageType* rootPage;
+			PageGuard rootGuard;
+			if (rootGuard.Pin(rootPid, rootPage) != OK) {
+				return DONE; // the entry is gone, the root stays as it is
+			}
+
+			if (rootPage->GetType() != INDEX_PAGE || !rootPage->IsEmpty()) {
+				break;
+			}
+
+			PageID childPid = rootPage->GetPrevPage();
+			rootGuard.Release();
+			FREEPAGE(rootPid);
+			rootPid = childPid;
+			header->SetRootPageID(rootPid);
+		}
+
+		return (fixStatus == OK) ? OK : DONE;
+	}
+
+protected:
+
+	BTreeHeaderPage* header;
+	const char * dbfile;
+
+	// A pair waiting to be inserted by InsertBatch.
+	struct BatchEntry {
+		KeyArg key;
+		RecordID rid;
+	};
+
+	// A page created by a split during InsertBatch, its separator, and
+	// the page it was split off from.
+	struct SplitEntry {
+		Key key;
+		PageID pid;
+		PageID leftPid;
+	};
+
+	// The most children one index page can have.
+	static const int MAX_CHILDREN = HEAPPAGE_DATA_SIZE / sizeof(PageID);
+
+
+	//-------------------------------------------------------------------
+	// BTreeCore::DestroyHelper
+	//
+	// Input   : currPid
+	// Output  : None
+	// Return  : OK if successful, FAIL otherwise.
+	// Purpose : Recursively frees currPid and all pages below it.
+	//-------------------------------------------------------------------
+	Status DestroyHelper(PageID currPid) {
+		ResizableRecordPage* currPage;
+		PIN(currPid, currPage);
+
+		if (currPage->GetType() == INDEX_PAGE) {
+			std::vector<PageID> children;
+			Traits::GetChildren((IndexPageType*) currPage, children);
+			for (unsigned int i = 0; i < children.size(); i++) {
+				Status s = DestroyHelper(children[i]);
+				if (s != OK) {
+					UNPIN(currPid, CLEAN);
+					return s;
+				}
+			}
+		}
+
+		UNPIN(currPid, CLEAN);
+		FREEPAGE(currPid);
+		return OK;
+	}
+
+
+	//-------------------------------------------------------------------
+	// BTreeCore::InsertHelper
+	//
+	// Input   : currPid - the current pid being traversed
+	//           key, rid - the entry to insert
+	// Output  : split - set if currPid was split
+	//           newChildKey, newChildPid - the separator and page ID of the
+	//                                      page split off from currPid
+	// Return  : OK if successful, FAIL otherwise.
+	// Purpose : Recursively traverse the tree to insert an index entry with
+	//           this rid and key. Split if necessary and propagate up to
+	//           parents.
+	//-------------------------------------------------------------------
+	Status InsertHelper(PageID currPid, KeyArg key, const RecordID rid,
+	                    bool& split, Key& newChildKey, PageID& newChildPid) {
+		ResizableRecordPage* currPage;
+		split = false;
+
+		// the guards unpin the current page, and a page split off from it,
+		// on every return
+		PageGuard currGuard;
+		PageGuard newGuard;
+		PIN_GUARD(currGuard, currPid, currPage);
+
+		if (currPage->GetType() == INDEX_PAGE) {
+			IndexPageType* indexPage = (IndexPageType*) currPage;
+			PageID childPid = Traits::FindChild(indexPage, key, false);
+
+			bool childSplit;
+			Key childKey;
+			PageID childNewPid;
+			Status s = InsertHelper(childPid, key, rid, childSplit, childKey, childNewPid);
+			if (s != OK || !childSplit) {
+				return s;
+			}
+
+			// the child split, add the new child to this page
+			currGuard.SetDirty();
+			if (indexPage->InsertAfter(childKey, childNewPid, childPid) == OK) {
+				return OK;
+			}
+
+			// no room in this page, split it and propagate up
+			IndexPageType* newPage;
+			NEWPAGE_GUARD(newGuard, newChildPid, newPage);
+			newPage->Init(newChildPid, INDEX_PAGE);
+			newPage->SetNextPage(INVALID_PAGE);
+			newPage->SetPrevPage(INVALID_PAGE);
+			if (SplitIndexPage(indexPage, newPage, childKey, childNewPid, childPid, newChildKey) != OK) {
+				// the split left indexPage as it was, so the new page is not used
+				newGuard.Release();
+				FREEPAGE(newChildPid);
+				return FAIL;
+			}
+
+			split = true;
+			return OK;
+
+		} else if (currPage->GetType() == LEAF_PAGE) {
+			LeafPageType* leafPage = (LeafPageType*) currPage;
+
+			currGuard.SetDirty();
+			if (leafPage->Insert(key, rid) == OK) {
+				return OK;
+			}
+
+			// split this page, propagate up to parent
+			LeafPageType* newPage;
+			NEWPAGE_GUARD(newGuard, newChildPid, newPage);
+			Traits::InitLeaf(newPage, newChildPid, header);
+			newPage->SetNextPage(INVALID_PAGE);
+			newPage->SetPrevPage(INVALID_PAGE);
+			if (SplitLeafPage(leafPage, newPage, key, rid, newChildKey) != OK) {
+				// the split left leafPage as it was, so the new page is not used
+				newGuard.Release();
+				FREEPAGE(newChildPid);
+				return FAIL;
+			}
+
+			split = true;
+			return OK;
+
+		} else {
+			return FAIL;
+		}
+	}
+
+
+	//-------------------------------------------------------------------
+	// BTreeCore::SplitLeafPage
+	//
+	// Input   : oldPage - the full leaf, pinned
+	//           newPage - an empty, pinned leaf to link in after it
+	//           key, rid - the entry that did not fit
+	// Output  : newChildKey - the separator to push up for newPage
+	// Return  : OK if successful, FAIL otherwise, in which case neither
+	//           page is changed.
+	// Purpose : Moves the upper part of oldPage to newPage, inserts the entry
+	//           into the page it belongs on, and links newPage into the leaf
+	//           chain after oldPage.
+	//-------------------------------------------------------------------
+	Status SplitLeafPage(LeafPageType* oldPage, LeafPageType* newPage, KeyArg key, const RecordID rid,
+	                     Key& newChildKey) {
+		// pin the next leaf before changing anything, so that failing to
+		// get a page leaves the tree as it was
+		PageGuard nextGuard;
+		ResizableRecordPage* nextPage = NULL;
+		PageID nextPid = oldPage->GetNextPage();
+		if (nextPid != INVALID_PAGE) {
+			PIN_GUARD(nextGuard, nextPid, nextPage);
+		}
+
+		Status s = Traits::SplitLeafEntries(oldPage, newPage, key, rid);
+		if (s != OK) {
+			return s;
+		}
+		Traits::LeafSeparator(oldPage, newPage, newChildKey);
+
+		// link the new page in after the old one
+		if (nextPage != NULL) {
+			nextPage->SetPrevPage(newPage->PageNo());
+			nextGuard.SetDirty();
+		}
+		newPage->SetNextPage(nextPid);
+		newPage->SetPrevPage(oldPage->PageNo());
+		oldPage->SetNextPage(newPage->PageNo());
+		return OK;
+	}
+
+
+	//-------------------------------------------------------------------
+	// BTreeCore::SplitIndexPage
+	//
+	// Input   : oldPage - the full index page
+	//           newPage - an empty index page to link in after it
+	//           key, pid - the child that did not fit
+	//           leftPid - the child pid was split off from. If key repeats,
+	//                     pid is placed right after it among the children
+	//                     of key.
+	// Output  : newChildKey - the key that moves up to the parent
+	// Return  : OK if successful, FAIL otherwise, in which case neither
+	//           page is changed.
+	// Purpose : Moves the upper part of oldPage to newPage. The first key of
+	//           the new page moves up, and its child becomes the leftmost
+	//           child (the prev page) of the new page. prevPage of an index
+	//           page is its leftmost child, so index levels only have
+	//           right-links.
+	//-------------------------------------------------------------------
+	Status SplitIndexPage(IndexPageType* oldPage, IndexPageType* newPage, KeyArg key, PageID pid,
+	                      PageID leftPid, Key& newChildKey) {
+		Status s = Traits::SplitIndexEntries(oldPage, newPage, key, pid, leftPid, newChildKey);
+		if (s != OK) {
+			return s;
+		}
+		newPage->SetNextPage(oldPage->GetNextPage());
+		oldPage->SetNextPage(newPage->PageNo());
+		return OK;
+	}
+
+
+	//-------------------------------------------------------------------
+	// BTreeCore::InsertBatchHelper
+	//
+	// Input   : currPid - the page the entries belong under
+	//           entries, numEntries - the sorted entries to insert
+	// Output  : newSiblings - gets the pages split off to the right of currPid,
+	//                         with their separators, in key order. They are
+	//                         added even if the call fails, since they are
+	//                         already linked in beside currPid.
+	// Return  : OK if successful, FAIL otherwise.
+	// Purpose : Recursive part of InsertBatch. Each run of entries bound for the
+	//           same child is passed down in one call. The current leaf stays
+	//           pinned while all of its entries go in.
+	//-------------------------------------------------------------------
+	Status InsertBatchHelper(PageID currPid, BatchEntry *entries, int numEntries,
+	                         std::vector<SplitEntry>& newSiblings) {
+		ResizableRecordPage* currPage;
+		Status s = OK;
+
+		// the guard unpins whichever page the batch is working on at return
+		PageGuard guard;
+		PIN_GUARD(guard, currPid, currPage);
+
+		if (currPage->GetType() == INDEX_PAGE) {
+			IndexPageType* indexPage = (IndexPageType*) currPage;
+			std::vector<SplitEntry> newChildren;
+
+			// Route every run first and add the split children afterwards, so
+			// the page is not changed while it is being used for routing.
+			int first = 0;
+			while (first < numEntries) {
+				PageID childPid = Traits::FindChild(indexPage, entries[first].key, false);
+				int last = first + 1;
+				while (last < numEntries && Traits::FindChild(indexPage, entries[last].key, false) == childPid) {
+					last++;
+				}
+
+				s = InsertBatchHelper(childPid, entries + first, last - first, newChildren);
+				if (s != OK) {
+					break;
+				}
+				first = last;
+			}
+
+			// children split off before a run failed still need their separators
+			Status indexStatus = InsertBatchIntoIndex(guard, indexPage, newChildren, newSiblings);
+			return (s != OK) ? s : indexStatus;
+
+		} else if (currPage->GetType() == LEAF_PAGE) {
+			std::vector<SplitEntry> siblings;
+			LeafPageType* target = (LeafPageType*) currPage;
+			PageID targetPid = currPid;
+			guard.SetDirty();
+
+			for (int i = 0; i < numEntries && s == OK; i++) {
+
+				// move to the page this key belongs on, if an earlier split moved it
+				int sibling = FindBatchSibling(siblings, entries[i].key);
+				PageID pid = (sibling < 0) ? currPid : siblings[sibling].pid;
+				if (pid != targetPid) {
+					s = guard.Pin(pid, target);
+					if (s != OK) {
+						std::cerr << "Unable to pin page " << pid << std::endl;
+						break;
+					}
+					guard.SetDirty();
+					targetPid = pid;
+				}
+
+				if (target->Insert(entries[i].key, entries[i].rid) == OK) {
+					continue;
+				}
+
+				// split this page, the new page goes right after it
+				LeafPageType* newLeafPage;
+				SplitEntry split;
+				PageGuard newGuard;
+				s = newGuard.New(split.pid, newLeafPage);
+				if (s != OK) {
+					std::cerr << "Unable to allocate new page " << split.pid << std::endl;
+					break;
+				}
+				Traits::InitLeaf(newLeafPage, split.pid, header);
+				newLeafPage->SetNextPage(INVALID_PAGE);
+				newLeafPage->SetPrevPage(INVALID_PAGE);
+
+				split.leftPid = targetPid;
+				s = SplitLeafPage(target, newLeafPage, entries[i].key, entries[i].rid, split.key);
+				if (s != OK) {
+					// target is left as it was, so the new page is not used
+					newGuard.Release();
+					MINIBASE_BM->FreePage(split.pid);
+					break;
+				}
+				siblings.insert(siblings.begin() + (sibling + 1), split);
+			}
+
+			newSiblings.insert(newSiblings.end(), siblings.begin(), siblings.end());
+			return s;
+
+		} else {
+			return FAIL;
+		}
+	}
+
+
+	//-------------------------------------------------------------------
+	// BTreeCore::InsertBatchIntoIndex
+	//
+	// Input   : guard - holds the pin on indexPage. It may be moved to a page
+	//                   split off from indexPage, and is left to the caller to
+	//                   release.
+	//           indexPage - the pinned index page to add children to
+	//           children - the new children and their separators, in key order
+	// Output  : newSiblings - gets the pages split off to the right of indexPage,
+	//                         with the keys to push up, in key order, even if
+	//                         the call fails
+	// Return  : OK if successful, FAIL otherwise.
+	// Purpose : Adds the children split off during InsertBatch to their parent,
+	//           splitting it as many times as needed.
+	//-------------------------------------------------------------------
+	Status InsertBatchIntoIndex(PageGuard& guard, IndexPageType* indexPage, std::vector<SplitEntry>& children,
+	                            std::vector<SplitEntry>& newSiblings) {
+		std::vector<SplitEntry> siblings;
+		PageID firstPid = indexPage->PageNo();
+		IndexPageType* target = indexPage;
+		PageID targetPid = firstPid;
+		Status s = OK;
+
+		if (!children.empty()) {
+			guard.SetDirty();
+		}
+
+		for (unsigned int i = 0; i < children.size() && s == OK; i++) {
+			int sibling = FindBatchSibling(siblings, children[i].key);
+			while (true) {
+				PageID pid = (sibling < 0) ? firstPid : siblings[sibling].pid;
+				if (pid != targetPid) {
+					s = guard.Pin(pid, target);
+					if (s != OK) {
+						std::cerr << "Unable to pin page " << pid << std::endl;
+						break;
+					}
+					guard.SetDirty();
+					targetPid = pid;
+				}
+
+				// A key equal to the separator of a split-off page can still
+				// belong before it, if the child it was split off from is there.
+				if (sibling < 0 || Traits::Compare(children[i].key, siblings[sibling].key) != 0 ||
+				    target->GetPrevPage() == children[i].leftPid ||
+				    target->Contains(children[i].key, children[i].leftPid)) {
+					break;
+				}
+				sibling--;
+			}
+			if (s != OK) {
+				break;
+			}
+
+			if (target->InsertAfter(children[i].key, children[i].pid, children[i].leftPid) == OK) {
+				continue;
+			}
+
+			// no room in this page, split it and push the middle key up
+			IndexPageType* newIndexPage;
+			SplitEntry split;
+			PageGuard newGuard;
+			s = newGuard.New(split.pid, newIndexPage);
+			if (s != OK) {
+				std::cerr << "Unable to allocate new page " << split.pid << std::endl;
+				break;
+			}
+			newIndexPage->Init(split.pid, INDEX_PAGE);
+			newIndexPage->SetNextPage(INVALID_PAGE);
+			newIndexPage->SetPrevPage(INVALID_PAGE);
+
+			split.leftPid = targetPid;
+			s = SplitIndexPage(target, newIndexPage, children[i].key, children[i].pid, children[i].leftPid, split.key);
+			if (s != OK) {
+				newGuard.Release();
+				MINIBASE_BM->FreePage(split.pid);
+				break;
+			}
+			siblings.insert(siblings.begin() + (sibling + 1), split);
+		}
+
+		newSiblings.insert(newSiblings.end(), siblings.begin(), siblings.end());
+		return s;
+	}
+
+
+	//-------------------------------------------------------------------
+	// BTreeCore::FindBatchSibling
+	//
+	// Input   : siblings - pages split off during InsertBatch, in key order
+	//           key - the key being inserted
+	// Output  : None
+	// Return  : The index of the last sibling whose separator is less than or
+	//           equal to key, or -1 if key belongs on the original page.
+	//-------------------------------------------------------------------
+	static int FindBatchSibling(std::vector<SplitEntry>& siblings, KeyArg key) {
+		int sibling = -1;
+		while (sibling + 1 < (int) siblings.size() && Traits::Compare(siblings[sibling + 1].key, key) <= 0) {
+			sibling++;
+		}
+		return sibling;
+	}
+
+
+	//-------------------------------------------------------------------
+	// BTreeCore::BatchEntryLess
+	//
+	// Input   : a, b - the entries to compare
+	// Output  : None
+	// Return  : true if a's key sorts before b's key.
+	//-------------------------------------------------------------------
+	static bool BatchEntryLess(const BatchEntry& a, const BatchEntry& b) {
+		return Traits::Compare(a.key, b.key) < 0;
+	}
+
+
+	//-------------------------------------------------------------------
+	// BTreeCore::BulkLoadAddChild
+	//
+	// Input   : levels - the pinned rightmost index page of each level
+	//           level - the level to add the child to, 0 being just above the leaves
+	//           key - separator of the new child
+	//           leftPid - the page before the new child on its level
+	//           pid - the new child
+	//           fillFactor - how full index pages may get
+	// Output  : None
+	// Return  : OK if successful, FAIL otherwise.
+	// Purpose : Appends a child to the rightmost page of a level during BulkLoad.
+	//           A full page is closed, and its last child and the new child
+	//           start the next page, so neither page is left without a key.
+	//           The last key of the full page moves up a level, as in
+	//           SplitIndexPage. A level is created once the level below gets
+	//           its second page.
+	//-------------------------------------------------------------------
+	Status BulkLoadAddChild(std::vector<IndexPageType*>& levels, unsigned int level, KeyArg key,
+	                        PageID leftPid, PageID pid, double fillFactor) {
+		if (level == levels.size()) {
+			IndexPageType* newLevelPage;
+			PageID newLevelPid;
+			NEWPAGE(newLevelPid, newLevelPage);
+			newLevelPage->Init(newLevelPid, INDEX_PAGE);
+			newLevelPage->SetNextPage(INVALID_PAGE);
+			newLevelPage->SetPrevPage(leftPid);
+			levels.push_back(newLevelPage);
+		}
+
+		// a page keeps two keys before it is filled, so it can give one away
+		IndexPageType* indexPage = levels[level];
+		bool filled = indexPage->GetNumOfRecords() >= 2 && Traits::PageFilled(indexPage, fillFactor);
+		if (!filled && indexPage->Insert(key, pid) == OK) {
+			return OK;
+		}
+
+		// the last child of the full page becomes the leftmost child of a
+		// new page, followed by the new child
+		Key upKey;
+		PageID lastChild;
+		if (Traits::GetLastEntry(indexPage, upKey, lastChild) != OK) {
+			return FAIL;
+		}
+
+		IndexPageType* newIndexPage;
+		PageID newIndexPid;
+		NEWPAGE(newIndexPid, newIndexPage);
+		newIndexPage->Init(newIndexPid, INDEX_PAGE);
+		newIndexPage->SetNextPage(INVALID_PAGE);
+		newIndexPage->SetPrevPage(lastChild);
+
+		// the new page is not on the level yet, so BulkLoad cannot free it
+		if (newIndexPage->Insert(key, pid) != OK || indexPage->Delete(upKey, lastChild) != OK) {
+			std::cout << "Error moving a child to a new index page in BulkLoad" << std::endl;
+			UNPIN(newIndexPid, CLEAN);
+			FREEPAGE(newIndexPid);
+			return FAIL;
+		}
+
+		PageID oldIndexPid = indexPage->PageNo();
+		indexPage->SetNextPage(newIndexPid);
+		levels[level] = newIndexPage;
+		UNPIN(oldIndexPid, DIRTY);
+
+		return BulkLoadAddChild(levels, level + 1, upKey, oldIndexPid, newIndexPid, fillFactor);
+	}
+
+
+	//-------------------------------------------------------------------
+	// BTreeCore::FreeLevel
+	//
+	// Input   : pid - the leftmost page to free
+	// Output  : None
+	// Return  : OK if successful, FAIL otherwise.
+	// Purpose : Frees a page and every page after it on its nextPage chain.
+	//           Used to throw away the pages of a failed BulkLoad.
+	//-------------------------------------------------------------------
+	Status FreeLevel(PageID pid) {
+		while (pid != INVALID_PAGE) {
+			ResizableRecordPage* page;
+			PIN(pid, page);
+			PageID nextPid = page->GetNextPage();
+			UNPIN(pid, CLEAN);
+			FREEPAGE(pid);
+			pid = nextPid;
+		}
+		return OK;
+	}
+
+
+	//-------------------------------------------------------------------
+	// BTreeCore::DeleteHelper
+	//
+	// Input   : currPid - the current pid being traversed
+	//           key, rid - the entry to delete
+	// Output  : underflow - set if currPid is left less than DELETE_MIN_FILL full
+	//           fixStatus - gets the status of a rebalance below currPid that
+	//                       failed. Left as it is if none did.
+	// Return  : OK if the entry was deleted, DONE if it is not in this subtree,
+	//           FAIL on error.
+	// Purpose : Recursively finds and deletes the entry, fixing up children
+	//           that underflow on the way back up.
+	//-------------------------------------------------------------------
+	Status DeleteHelper(PageID currPid, KeyArg key, const RecordID rid, bool& underflow, Status& fixStatus) {
+		ResizableRecordPage* currPage;
+		Status s = DONE;
+		underflow = false;
+
+		PageGuard currGuard; // unpins currPid on every return
+		PIN_GUARD(currGuard, currPid, currPage);
+
+		if (currPage->GetType() == INDEX_PAGE) {
+			IndexPageType* indexPage = (IndexPageType*) currPage;
+
+			// Values of key can start in the last child with a smaller key and
+			// continue through each child of key itself, so try those in order.
+			PageID children[MAX_CHILDREN];
+			int numChildren = Traits::FindKeyChildren(indexPage, key, children, MAX_CHILDREN);
+
+			bool childUnderflow = false;
+			PageID childPid = INVALID_PAGE;
+			for (int i = 0; i < numChildren && s == DONE; i++) {
+				childPid = children[i];
+				s = DeleteHelper(childPid, key, rid, childUnderflow, fixStatus);
+			}
+
+			if (s != OK) {
+				return s;
+			}
+
+			// The entry is gone. A rebalance that fails, e.g. because it could
+			// not pin a sibling, leaves the pages as they were, only emptier,
+			// so the delete goes on and Delete reports it.
+			currGuard.SetDirty();
+			if (childUnderflow) {
+				Status fs = FixUnderflow(indexPage, childPid);
+				if (fs != OK) {
+					fixStatus = fs;
+				}
+			}
+
+			underflow = Traits::PageUnderflows(indexPage);
+			return OK;
+
+		} else if (currPage->GetType() == LEAF_PAGE) {
+			LeafPageType* leafPage = (LeafPageType*) currPage;
+
+			if (leafPage->Delete(key, rid) != OK) {
+				return DONE;
+			}
+
+			currGuard.SetDirty();
+			underflow = Traits::PageUnderflows(leafPage);
+			return OK;
+
+		} else {
+			return FAIL;
+		}
+	}
+
+
+	//-------------------------------------------------------------------
+	// BTreeCore::FixUnderflow
+	//
+	// Input   : parent - the pinned parent of the underflowing page
+	//           childPid - the page that underflowed
+	// Output  : None
+	// Return  : OK if successful, FAIL otherwise.
+	// Purpose : Merges the child with its right sibling (or its left one, if
+	//           it is the last child) when both fit on one page, and moves
+	//           entries between them otherwise. The separator in the parent
+	//           is removed or replaced to match.
+	// Note    : OK does not always mean the child is no longer underfull;
+	//           see RebalanceLeaves and RebalanceIndexPages.
+	//-------------------------------------------------------------------
+	Status FixUnderflow(IndexPageType* parent, PageID childPid) {
+		PageID leftPid;
+		PageID rightPid;
+		Key sep; // key of rightPid in parent
+		if (!Traits::FindSiblings(parent, childPid, leftPid, rightPid, sep)) {
+			return OK; // an only child has nothing to merge with
+		}
+
+		// the rebalance releases the right page early if it frees it
+		ResizableRecordPage* left;
+		ResizableRecordPage* right;
+		PageGuard leftGuard;
+		PageGuard rightGuard;
+		PIN_GUARD(leftGuard, leftPid, left);
+		PIN_GUARD(rightGuard, rightPid, right);
+		leftGuard.SetDirty();
+
+		if (left->GetType() == LEAF_PAGE) {
+			return RebalanceLeaves(parent, (LeafPageType*) left, rightGuard, (LeafPageType*) right, sep);
+		} else {
+			return RebalanceIndexPages(parent, (IndexPageType*) left, rightGuard, (IndexPageType*) right, sep);
+		}
+	}
+
+
+	//-------------------------------------------------------------------
+	// BTreeCore::RebalanceLeaves
+	//
+	// Input   : parent - the pinned parent of both leaves
+	//           left, right - adjacent pinned leaves. right is freed if it is
+	//                         merged into left.
+	//           rightGuard - holds the pin on right
+	//           sep - the key of right in parent
+	// Output  : None
+	// Return  : OK if successful, FAIL otherwise.
+	// Purpose : Merges or redistributes two adjacent leaves.
+	// Note    : If the leaves must be redistributed but the parent might 
+	//           not have room for a longer separator, nothing is moved and
+	//           the underfull leaf stays as it is. OK is still returned,
+	//           since the tree is valid; the next delete that underflows 
+	//           the leaf tries again.
+	//-------------------------------------------------------------------
+	Status RebalanceLeaves(IndexPageType* parent, LeafPageType* left, PageGuard& rightGuard,
+	                       LeafPageType* right, KeyArg sep) {
+		PageID leftPid = left->PageNo();
+		PageID rightPid = right->PageNo();
+
+		LeafPageType merged;
+		if (Traits::LeavesFit(left, right, &merged)) {
+			// pin the leaf after right before changing anything, so a failed
+			// pin leaves both leaves as they were
+			PageID nextPid = right->GetNextPage();
+			PageGuard nextGuard;
+			if (nextPid != INVALID_PAGE) {
+				ResizableRecordPage* nextPage;
+				PIN_GUARD(nextGuard, nextPid, nextPage);
+				nextPage->SetPrevPage(leftPid);
+				nextGuard.SetDirty();
+			}
+
+			// unlink right from the leaf chain
+			Traits::MergeLeaves(left, right, &merged);
+			left->SetNextPage(nextPid);
+
+			parent->Delete(sep, rightPid);
+			rightGuard.Release();
+			FREEPAGE(rightPid);
+			return OK;
+		}
+
+		// The new separator may be longer than the old one. Leave the pages
+		// as they are, one of them still underfull, if the parent might not
+		// have room for it.
+		if (!Traits::HasRoomForSeparator(parent)) {
+			return OK;
+		}
+		rightGuard.SetDirty();
+
+		Key newSep;
+		Traits::RedistributeLeaves(left, right, newSep);
+
+		// replace the separator of right
+		parent->Delete(sep, rightPid);
+		return parent->InsertAfter(newSep, rightPid, leftPid);
+	}
+
+
+	//-------------------------------------------------------------------
+	// BTreeCore::RebalanceIndexPages
+	//
+	// Input   : parent - the pinned parent of both pages
+	//           left, right - adjacent pinned index pages. right is freed if
+	//                         it is merged into left.
+	//           rightGuard - holds the pin on right
+	//           sep - the key of right in parent
+	// Output  : None
+	// Return  : OK if successful, FAIL otherwise.
+	// Purpose : Merges or redistributes two adjacent index pages. Entries
+	//           move through the parent: the separator comes down with the
+	//           leftmost child of right, and a key of the page that gives
+	//           entries goes up in its place.
+	// Note    : As in RebalanceLeaves, if the parent might not have room 
+	//           for a longer separator, nothing is moved, the underfull 
+	//           page stays as it is and OK is returned.
+	//-------------------------------------------------------------------
+	Status RebalanceIndexPages(IndexPageType* parent, IndexPageType* left, PageGuard& rightGuard,
+	                           IndexPageType* right, KeyArg sep) {
+		PageID leftPid = left->PageNo();
+		PageID rightPid = right->PageNo();
+
+		IndexPageType merged;
+		if (Traits::IndexPagesFit(left, sep, right, &merged)) {
+			Traits::MergeIndexPages(left, sep, right, &merged);
+			left->SetNextPage(right->GetNextPage());
+
+			parent->Delete(sep, rightPid);
+			rightGuard.Release();
+			FREEPAGE(rightPid);
+			return OK;
+		}
+
+		// leave the pages underfull, as for leaves
+		if (!Traits::HasRoomForSeparator(parent)) {
+			return OK;
+		}
+		rightGuard.SetDirty();
+
+		Key newSep;
+		Traits::RedistributeIndexPages(left, sep, right, newSep);
+
+		parent->Delete(sep, rightPid);
+		return parent->InsertAfter(newSep, rightPid, leftPid);
+	}
+};
+
+#endif
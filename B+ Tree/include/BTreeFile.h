@@ -5,47 +5,82 @@
 #include "BTreeFileScan.h"
 #include "BTreeTest.h"
 #include "BTreeInclude.h"
-
-enum SplitStatus {
-	NEEDS_SPLIT,
-	CLEAN_INSERT
+#include "BulkLoadSource.h"
+#include "BTreeCore.h"
+
+#include <vector>
+
+//-------------------------------------------------------------------
+// StringKeyTraits
+//
+// The page operations BTreeCore needs for string keys on SortedKVPages
+// (IndexPage and LeafPage). Keys are NUL-terminated strings shorter than
+// MAX_KEY_LENGTH. Pages are split, merged and filled by the space their
+// records take, and leaf splits push up the shortest separator.
+//-------------------------------------------------------------------
+struct StringKeyTraits {
+	typedef const char* KeyArg;
+	typedef char Key[MAX_KEY_LENGTH];
+	typedef IndexPage IndexPageType;
+	typedef LeafPage LeafPageType;
+	typedef BulkLoadSource SourceType;
+
+	static int Compare(const char *a, const char *b) { return KeyCompare(a, b); }
+	static void CopyKey(char *dest, const char *src) { strcpy(dest, src); }
+	static bool KeyFits(const char *key) { return strlen(key) < MAX_KEY_LENGTH; }
+
+	static void StringKeyTraits::InitLeaf(LeafPage* page, PageID pid, BTreeHeaderPage* header);
+	static PageID StringKeyTraits::FindChild(IndexPage* indexPage, const char *key, bool strict);
+	static void StringKeyTraits::GetChildren(IndexPage* indexPage, std::vector<PageID>& children);
+	static int StringKeyTraits::FindKeyChildren(IndexPage* indexPage, const char *key, PageID *children, int maxChildren);
+	static bool StringKeyTraits::FindSiblings(IndexPage* parent, PageID childPid, PageID& leftPid, PageID& rightPid, char *sep);
+	static Status StringKeyTraits::SplitLeafEntries(LeafPage* oldPage, LeafPage* newPage, const char *key, const RecordID rid);
+	static void StringKeyTraits::LeafSeparator(LeafPage* oldPage, LeafPage* newPage, char *separator);
+	static Status StringKeyTraits::SplitIndexEntries(IndexPage* oldPage, IndexPage* newPage, const char *key, PageID pid, 
+	                                                  PageID leftPid, char *upKey);
+	static void StringKeyTraits::Separator(const char *leftMax, const char *rightMin, char *separator);
+	static Status StringKeyTraits::GetLastEntry(IndexPage* indexPage, char *key, PageID& pid);
+	static bool StringKeyTraits::PageFilled(ResizableRecordPage* page, double fillFactor);
+	static bool StringKeyTraits::PageUnderflows(ResizableRecordPage* page);
+	static bool StringKeyTraits::LeavesFit(LeafPage* left, LeafPage* right, LeafPage* merged);
+	static void StringKeyTraits::MergeLeaves(LeafPage* left, LeafPage* right, LeafPage* merged);
+	static bool StringKeyTraits::IndexPagesFit(IndexPage* left, const char *sep, IndexPage* right, IndexPage* merged);
+	static void StringKeyTraits::MergeIndexPages(IndexPage* left, const char *sep, IndexPage* right, IndexPage* merged);
+	static bool StringKeyTraits::HasRoomForSeparator(IndexPage* parent);
+	static void StringKeyTraits::RedistributeLeaves(LeafPage* left, LeafPage* right, char *newSep);
+	static void StringKeyTraits::RedistributeIndexPages(IndexPage* left, const char *sep, IndexPage* right, char *newSep);
 };
 
-class BTreeFile {
+//-------------------------------------------------------------------
+// BTreeFile
+//
+// A B+ tree over string keys. Inserts, deletes and loading come from
+// BTreeCore; this class adds the searches and scans, which use the
+// ceiling separators on the way down.
+//-------------------------------------------------------------------
+class BTreeFile : public BTreeCore<StringKeyTraits> {
 
 public:
 	friend class BTreeDriver;
 
-	BTreeFile(Status& status, const char *filename);
-
-	Status DestroyFile();
-
-	~BTreeFile();
-
-	Status Insert(const char *key, const RecordID rid);
+	BTreeFile(Status& status, const char *filename, bool prefixCompressLeaves = false);
 
 	BTreeFileScan* OpenScan(const char* lowKey, const char* highKey);
 
+	Status Lookup(const char *key, RecordID *rids, int maxRids, int& numRids);
+
 	Status PrintTree (PageID pageID, bool printContents);
 	Status PrintWhole (bool printContents = false);	
 
 
 private:
 
-	BTreeHeaderPage* header;
-	const char * dbfile;
-
-	Status BTreeFile::DestroyHelper(PageID currPid);
-	Status BTreeFile::InsertHelper(PageID currPid, SplitStatus& st, char*& newChildKey, PageID & newChildPageID, const char *key, const RecordID rid);
-	Status BTreeFile::SplitLeafPage(LeafPage* oldPage, LeafPage* newPage, const char *key, const RecordID rid);
-	Status BTreeFile::SplitIndexPage(IndexPage* oldPage, IndexPage* newPage, const char *key, const PageID rid, char *&newPageKey);
-
 	//Please don't delete this method. It's used for testing, 
 	// and may be useful for you.
 	PageID GetLeftLeaf();
 
-	Status BTreeFile::_searchTree( const char *key,  PageID currentID, PageID& lowIndex); //function to find leaf page to start scan
-	Status BTreeFile::_searchIndexNode(const char *key,  PageID currentID, IndexPage *currentIndex, PageID& lowIndex); //function to get child of index page to find leaf to scan
+	Status BTreeFile::_searchTree( const char *key,  PageID currentID, PageGuard& leafGuard, LeafPage*& leafPage, 
+		                           char *upperKey, bool& bounded); //function to find and pin leaf page to start scan
 
 };
 
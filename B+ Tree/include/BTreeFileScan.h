@@ -33,12 +33,14 @@ private:
 	// You may add private methods here. 
 	const char * lowKey; // min key in scan
     const char * highKey; // max key in scan
-	PageID currentPageID; // pageID that scan is currently on
     bool done; // true when scan is done
 	PageKVScan<RecordID>* scan; // scan for a given page
 	LeafPage* currentPage; // page that scan is currently on
+	PageGuard pageGuard; // holds the pin on currentPage until the scan moves on or is done
 
-	Status BTreeFileScan::_SetIter(); //function to initialize PageKVScan scan to starting point for the low key
+	Status BTreeFileScan::_SetIter(PageID pid); //function to pin pid and open the PageKVScan scan on it
+	Status BTreeFileScan::_OpenIter(); //function to open PageKVScan scan on the already pinned current page
+	Status BTreeFileScan::_EndScan(); //function to unpin the current page once the scan is done
 
 };
 
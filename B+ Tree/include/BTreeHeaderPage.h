@@ -3,6 +3,20 @@
 
 #include "heappage.h"
 
+// Layout of the header data: the root page ID, the leaf prefix compression
+// flag at sizeof(PageID), HEADER_MAGIC at 2 * sizeof(PageID), and the key
+// type at 3 * sizeof(PageID). Headers written before these fields existed
+// hold whatever was on the page after the root page ID, so the fields after
+// it are only trusted when HEADER_MAGIC is in place. A legacy header whose
+// leftover bytes happen to equal HEADER_MAGIC would be misread.
+// The page size is not recorded: it is MINIBASE_PAGESIZE, which is compiled
+// into the buffer manager and database library and is the same for every file.
+#define HEADER_MAGIC 0x42545248 // "BTRH"
+
+// Key types an index can be built with. Legacy headers are string indexes.
+#define HEADER_KEY_STRING 0 // BTreeFile
+#define HEADER_KEY_INT64  1 // IntBTreeFile
+
 class BTreeHeaderPage : HeapPage {
 
 private:
@@ -13,6 +27,9 @@ public:
 	void Init(PageID hpid) {
 		HeapPage::Init(hpid);
 		SetRootPageID(INVALID_PAGE);
+		SetLeafPrefixCompression(false);
+		SetMagic();
+		SetKeyType(HEADER_KEY_STRING);
 	}
 
 	// Returns the page id of the root.
@@ -25,6 +42,46 @@ public:
 		PageID* ptr = (PageID*) (HeapPage::data);
 		*ptr = pid;
 	}
+
+	// Returns whether leaf pages of this index store a common key prefix.
+	// Legacy headers never do.
+	bool GetLeafPrefixCompression() {
+		if(!HasMagic()) {
+			return false;
+		}
+		return *(HeapPage::data + sizeof(PageID)) != 0;
+	}
+
+	// Sets whether new leaf pages of this index store a common key prefix.
+	void SetLeafPrefixCompression(bool compress) {
+		*(HeapPage::data + sizeof(PageID)) = compress ? 1 : 0;
+	}
+
+	// Returns the type of the keys in the index, HEADER_KEY_STRING or 
+	// HEADER_KEY_INT64. Legacy headers are HEADER_KEY_STRING.
+	int GetKeyType() {
+		if(!HasMagic()) {
+			return HEADER_KEY_STRING;
+		}
+		return *((int*) (HeapPage::data + 3 * sizeof(PageID)));
+	}
+
+	// Sets the type of the keys in the index.
+	void SetKeyType(int keyType) {
+		int* ptr = (int*) (HeapPage::data + 3 * sizeof(PageID));
+		*ptr = keyType;
+	}
+
+	// Returns true if the header was written with the fields above.
+	bool HasMagic() {
+		return *((int*) (HeapPage::data + 2 * sizeof(PageID))) == HEADER_MAGIC;
+	}
+
+	// Marks the fields after the root page ID as written.
+	void SetMagic() {
+		int* ptr = (int*) (HeapPage::data + 2 * sizeof(PageID));
+		*ptr = HEADER_MAGIC;
+	}
 };
 
 
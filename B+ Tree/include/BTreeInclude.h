@@ -2,9 +2,10 @@
 #define _B_TREE_INCLUDE_H_
 
 #include "SortedKVPage.h"
+#include "FixedKVPage.h"
+#include "PageGuard.h"
 
-// Useful definitions. 
-#define MAX_KEY_LENGTH 128
+// Useful definitions. MAX_KEY_LENGTH is defined in SortedKVPage.h.
 #define INDEX_PAGE 0
 #define LEAF_PAGE 1
 
@@ -12,10 +13,19 @@
 // this should suffice. 
 #define MAX_TREE_DEPTH 4
 
+// Fraction of a page that must stay in use after a delete. Emptier pages
+// are merged with or borrow from a sibling. 
+#define DELETE_MIN_FILL 0.5
+
 // Define index and leaf page types 
 typedef SortedKVPage<PageID> IndexPage;
 typedef SortedKVPage<RecordID> LeafPage;
 
+// Key and page types of IntBTreeFile, which indexes 64-bit integers
+typedef long long IntKey;
+typedef FixedKVPage<IntKey, PageID> IntIndexPage;
+typedef FixedKVPage<IntKey, RecordID> IntLeafPage;
+
 
 // Helper Macros. Feel free you use these if you want. 
 #define PIN(a, b)   if (MINIBASE_BM->PinPage((a), (Page *&)(b)) != OK) {\
@@ -27,6 +37,13 @@ typedef SortedKVPage<RecordID> LeafPage;
 #define NEWPAGE(a, b)  if (MINIBASE_BM->NewPage((a), (Page *&)(b)) != OK) {\
 						std::cerr << "Unable to allocate new page " << a << std::endl; return FAIL;}
 
+// Same as PIN and NEWPAGE, but the page is held by the PageGuard g, 
+// which unpins it on every return. 
+#define PIN_GUARD(g, a, b)  if ((g).Pin((a), (b)) != OK) {\
+						std::cerr << "Unable to pin page " << a << std::endl; return FAIL;}
+#define NEWPAGE_GUARD(g, a, b)  if ((g).New((a), (b)) != OK) {\
+						std::cerr << "Unable to allocate new page " << a << std::endl; return FAIL;}
+
 #define DIRTY TRUE
 #define CLEAN FALSE
 
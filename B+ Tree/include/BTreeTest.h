@@ -2,6 +2,7 @@
 #define _B_TREE_DRIVER_H_
 
 #include "BTreeFile.h"
+#include "IntBTreeFile.h"
 
 class BTreeDriver {
 public:
@@ -31,7 +32,15 @@ public:
 	                       int ridOffset = 1, int pad = 4);
 
 	static bool TestNumLeafPages(BTreeFile* btf, int expected);
+	static int  CountLeafPages(BTreeFile* btf);
+	static int  CountIntLeafPages(IntBTreeFile* ibtf);
+	static bool TestRightLinks(BTreeFile* btf);
+	static bool TestIndexKeys(BTreeFile* btf);
+	static int  TreeHeight(BTreeFile* btf);
 	static bool TestScanCount(BTreeFileScan* scan, int expected);
+	static bool TestKeyPair(const char* a, const char* b);
+	static bool TestKeySearch(const char* key, const char* const* keys, int numKeys);
+	static int  ByteCompare(const char* a, const char* b);
 	static bool TestNumEntries(BTreeFile* btf, int expected);
 	
 	static bool TestBalance(BTreeFile* btf,
@@ -49,6 +58,18 @@ public:
 	static bool TestModifiedInserts();
 	static bool TestLargeWorkload();
 	static bool TestPerformance();
+	static bool TestKeyCompare();
+	static bool TestPrefixCompression();
+	static bool TestSeparatorTruncation();
+	static bool TestBulkLoad();
+	static bool TestInsertBatch();
+	static bool TestLookup();
+	static bool TestDelete();
+	static bool TestIntKeys();
+	static bool TestLegacyHeader();
+	static bool TestIndexRightLinks();
+	static bool TestScanDescent();
+	static bool TestPinFailures();
 
 };
 
@@ -0,0 +1,31 @@
+#ifndef _BULK_LOAD_SOURCE_H_
+#define _BULK_LOAD_SOURCE_H_
+
+#include "minirel.h"
+#include "BTreeInclude.h"
+
+// A stream of (key, rid) pairs in ascending key order, consumed by
+// BTreeFile::BulkLoad. Pairs with equal keys must be adjacent.
+class BulkLoadSource {
+
+public:
+	virtual ~BulkLoadSource() {}
+
+	// Retrieves the next pair. Returns OK if a pair was returned, DONE
+	// once the stream is exhausted and FAIL on error. The key only has
+	// to stay valid until the next call. 
+	virtual Status GetNext(const char*& key, RecordID& rid) = 0;
+};
+
+// The same stream with integer keys, consumed by IntBTreeFile::BulkLoad.
+class IntBulkLoadSource {
+
+public:
+	virtual ~IntBulkLoadSource() {}
+
+	// Retrieves the next pair. Returns OK if a pair was returned, DONE
+	// once the stream is exhausted and FAIL on error.
+	virtual Status GetNext(IntKey& key, RecordID& rid) = 0;
+};
+
+#endif
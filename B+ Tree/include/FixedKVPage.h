@@ -0,0 +1,370 @@
+#ifndef _FIXED_KV_PAGE_
+#define _FIXED_KV_PAGE_
+
+#include "ResizableRecordPage.h"
+
+//-------------------------------------------------------------------
+// FixedKVPage
+//
+// A sorted page of fixed-width key-value pairs, for keys such as 64-bit
+// integers that do not need to be stored as strings. The keys are packed
+// back to back at the start of the data area, followed by room for 
+// CAPACITY values, so there is no slot array, no record lengths and no
+// padding between a key and its value: key i is at 
+// data + i * sizeof(KeyType), and its value at 
+// data + CAPACITY * sizeof(KeyType) + i * sizeof(ValType). Binary searches
+// only touch the key array. The numOfSlots field of the page holds the 
+// number of entries.
+//
+// Keys are compared with the < and == operators of KeyType. A key
+// inserted more than once gets one entry per value, in insertion order.
+//-------------------------------------------------------------------
+template<typename KeyType, typename ValType>
+class FixedKVPage : public ResizableRecordPage {
+
+public:
+	// Number of entries that fit on one page.
+	static const int CAPACITY = HEAPPAGE_DATA_SIZE / (sizeof(KeyType) + sizeof(ValType));
+
+private:
+
+	// Returns the array of keys on this page.
+	KeyType* GetKeys() {
+		return (KeyType*) data;
+	}
+
+	// Returns the array of values on this page, which follows room for 
+	// CAPACITY keys.
+	ValType* GetValues() {
+		return (ValType*) (data + CAPACITY * sizeof(KeyType));
+	}
+
+
+public:
+
+	//-------------------------------------------------------------------
+	// FixedKVPage::InsertAt
+	//
+	// Input   : pos, the position the new entry will have.
+	//           key, val, the entry to insert.
+	// Output  : None.
+	// Return  : OK   if the entry was inserted.
+	//           FAIL if the page is full.
+	// Purpose : Shifts the entries from pos on over by one and stores the
+	//           new entry in the gap.
+	//-------------------------------------------------------------------
+	Status InsertAt(int pos, KeyType key, ValType val) {
+		if(IsFull()) {
+			return FAIL;
+		}
+		KeyType* keys = GetKeys();
+		ValType* vals = GetValues();
+		memmove(keys + pos + 1, keys + pos, (numOfSlots - pos) * sizeof(KeyType));
+		memmove(vals + pos + 1, vals + pos, (numOfSlots - pos) * sizeof(ValType));
+		keys[pos] = key;
+		vals[pos] = val;
+		numOfSlots++;
+		freeSpace -= sizeof(KeyType) + sizeof(ValType);
+		return OK;
+	}
+
+
+	//-------------------------------------------------------------------
+	// FixedKVPage::DeleteAt
+	//
+	// Input   : pos, the position of the entry to delete.
+	// Output  : None.
+	// Return  : None.
+	// Purpose : Removes an entry, shifting the following entries back.
+	//-------------------------------------------------------------------
+	void DeleteAt(int pos) {
+		KeyType* keys = GetKeys();
+		ValType* vals = GetValues();
+		memmove(keys + pos, keys + pos + 1, (numOfSlots - pos - 1) * sizeof(KeyType));
+		memmove(vals + pos, vals + pos + 1, (numOfSlots - pos - 1) * sizeof(ValType));
+		numOfSlots--;
+		freeSpace += sizeof(KeyType) + sizeof(ValType);
+	}
+
+
+	//-------------------------------------------------------------------
+	// FixedKVPage::Init
+	//
+	// Input   : pid, the PageID of this page.
+	//           indexType, the type of this page
+	//                      -- whether it is index or leaf.
+	// Output  : None.
+	// Return  : None.
+	// Purpose : Initializes this page as an empty page of the given type.
+	//-------------------------------------------------------------------
+	void Init(PageID pid, short indexType) {
+		HeapPage::Init(pid);
+		type = indexType;
+		numOfSlots = 0;
+		freePtr = 0;
+		freeSpace = CAPACITY * (sizeof(KeyType) + sizeof(ValType));
+	}
+
+
+	// Accessor methods.
+	int     GetNumEntries()    { return numOfSlots; }
+	bool    IsEmpty()          { return numOfSlots == 0; }
+	bool    IsFull()           { return numOfSlots == CAPACITY; }
+	KeyType GetKey(int pos)    { return GetKeys()[pos]; }
+	ValType GetValue(int pos)  { return GetValues()[pos]; }
+
+	// Replaces the key at pos. The caller keeps the keys in order.
+	void    SetKey(int pos, KeyType key) { GetKeys()[pos] = key; }
+
+
+	//-------------------------------------------------------------------
+	// FixedKVPage::LowerBound
+	//
+	// Input   : key, the key to search for.
+	// Output  : None.
+	// Return  : The position of the first entry whose key is not smaller
+	//           than key, or the number of entries if there is none.
+	// Purpose : Binary search over the entries. Each probe is a single
+	//           compare of two keys.
+	//-------------------------------------------------------------------
+	int LowerBound(KeyType key) {
+		KeyType* keys = GetKeys();
+		int low = 0;
+		int high = numOfSlots;
+		while(low < high) {
+			int mid = (low + high) / 2;
+			if(keys[mid] < key) {
+				low = mid + 1;
+			}
+			else {
+				high = mid;
+			}
+		}
+		return low;
+	}
+
+
+	//-------------------------------------------------------------------
+	// FixedKVPage::UpperBound
+	//
+	// Input   : key, the key to search for.
+	// Output  : None.
+	// Return  : The position of the first entry whose key is larger than
+	//           key, or the number of entries if there is none.
+	//-------------------------------------------------------------------
+	int UpperBound(KeyType key) {
+		KeyType* keys = GetKeys();
+		int low = 0;
+		int high = numOfSlots;
+		while(low < high) {
+			int mid = (low + high) / 2;
+			if(key < keys[mid]) {
+				high = mid;
+			}
+			else {
+				low = mid + 1;
+			}
+		}
+		return low;
+	}
+
+
+	//-------------------------------------------------------------------
+	// FixedKVPage::Insert
+	//
+	// Input   : key, the key to insert.
+	//           val, the value to insert.
+	// Output  : None.
+	// Return  : OK   if the key-value pair was inserted successfully.
+	//           FAIL if the page is full.
+	// Purpose : Inserts a key value pair after all entries with a key
+	//           smaller than or equal to it.
+	//-------------------------------------------------------------------
+	Status Insert(KeyType key, ValType val) {
+		return InsertAt(UpperBound(key), key, val);
+	}
+
+
+	//-------------------------------------------------------------------
+	// FixedKVPage::InsertAfter
+	//
+	// Input   : key, the key to insert.
+	//           val, the value to insert.
+	//           leftVal, the value val should follow.
+	// Output  : None.
+	// Return  : OK   if the key-value pair was inserted successfully.
+	//           FAIL if the page is full.
+	// Purpose : Same as Insert, but among the entries for key val is put
+	//           right after leftVal, or first if leftVal is not there.
+	//           Index pages use this to keep the children of a repeated
+	//           separator in the order of the tree, as SortedKVPage does.
+	//-------------------------------------------------------------------
+	Status InsertAfter(KeyType key, ValType val, ValType leftVal) {
+		int first = LowerBound(key);
+		int end = UpperBound(key);
+		int pos = first;
+		for(int i = end - 1; i >= first; i--) {
+			if(GetValue(i) == leftVal) {
+				pos = i + 1;
+				break;
+			}
+		}
+		return InsertAt(pos, key, val);
+	}
+
+
+	//-------------------------------------------------------------------
+	// FixedKVPage::Delete
+	//
+	// Input   : key, the key to delete.
+	//           val, the value to delete.
+	// Output  : None.
+	// Return  : OK   if the key-value pair was deleted successfully.
+	//           FAIL if the key-value pair is not present.
+	//-------------------------------------------------------------------
+	Status Delete(KeyType key, ValType val) {
+		int end = UpperBound(key);
+		for(int i = LowerBound(key); i < end; i++) {
+			if(GetValue(i) == val) {
+				DeleteAt(i);
+				return OK;
+			}
+		}
+		return FAIL;
+	}
+
+
+	//-------------------------------------------------------------------
+	// FixedKVPage::Contains
+	//
+	// Input   : key, the key to test for.
+	//           val, the value to test for.
+	// Output  : None.
+	// Return  : true  if the key value pair is present on this page.
+	//           false otherwise.
+	//-------------------------------------------------------------------
+	bool Contains(KeyType key, ValType val) {
+		int end = UpperBound(key);
+		for(int i = LowerBound(key); i < end; i++) {
+			if(GetValue(i) == val) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+
+	//-------------------------------------------------------------------
+	// FixedKVPage::FindChild
+	//
+	// Input   : key, the key to search for.
+	//           strict, whether to skip entries equal to the search key.
+	// Output  : None.
+	// Return  : The value of the last entry with a key smaller than or
+	//           equal to key (only smaller, if strict is set), or the
+	//           prevPage pointer if there is none.
+	// Purpose : Picks the child to descend to on an index page.
+	//-------------------------------------------------------------------
+	PageID FindChild(KeyType key, bool strict = false) {
+		int pos = strict ? LowerBound(key) : UpperBound(key);
+		return (pos == 0) ? GetPrevPage() : GetValue(pos - 1);
+	}
+
+
+	//-------------------------------------------------------------------
+	// FixedKVPage::MoveUpperHalf
+	//
+	// Input   : newPage, an empty page.
+	// Output  : None.
+	// Return  : None.
+	// Purpose : Moves the upper half of the entries on this page to
+	//           newPage with one block copy of the keys and one of the 
+	//           values.
+	//-------------------------------------------------------------------
+	void MoveUpperHalf(FixedKVPage* newPage) {
+		int keep = numOfSlots / 2;
+		int moved = numOfSlots - keep;
+		memcpy(newPage->GetKeys(), GetKeys() + keep, moved * sizeof(KeyType));
+		memcpy(newPage->GetValues(), GetValues() + keep, moved * sizeof(ValType));
+
+		newPage->numOfSlots = moved;
+		newPage->freeSpace = (CAPACITY - moved) * (sizeof(KeyType) + sizeof(ValType));
+		numOfSlots = keep;
+		freeSpace = (CAPACITY - keep) * (sizeof(KeyType) + sizeof(ValType));
+	}
+
+
+	//-------------------------------------------------------------------
+	// FixedKVPage::PopFirst
+	//
+	// Input   : None.
+	// Output  : key, val, the first entry on the page.
+	// Return  : None.
+	// Purpose : Removes the first entry. Used after an index split, where
+	//           the first key of the new page moves up to the parent and
+	//           its child becomes the prevPage of the new page.
+	//-------------------------------------------------------------------
+	void PopFirst(KeyType& key, ValType& val) {
+		key = GetKey(0);
+		val = GetValue(0);
+		DeleteAt(0);
+	}
+
+
+	//-------------------------------------------------------------------
+	// FixedKVPage::MoveEntries
+	//
+	// Input   : first, count, the range of entries to move.
+	//           destPage, the page to move them to.
+	//           destPos, the position the first moved entry will have on
+	//                    destPage.
+	// Output  : None.
+	// Return  : None.
+	// Purpose : Moves count entries to destPage with one block copy of the
+	//           keys and one of the values, shifting the entries of 
+	//           destPage from destPos on out of the way. Used to merge and
+	//           redistribute siblings after a delete.
+	// Note    : The caller makes sure that destPage has room for count more
+	//           entries and that the keys stay in order.
+	//-------------------------------------------------------------------
+	void MoveEntries(int first, int count, FixedKVPage* destPage, int destPos) {
+		KeyType* keys = GetKeys();
+		ValType* vals = GetValues();
+		KeyType* destKeys = destPage->GetKeys();
+		ValType* destVals = destPage->GetValues();
+		int destTail = destPage->numOfSlots - destPos;
+		memmove(destKeys + destPos + count, destKeys + destPos, destTail * sizeof(KeyType));
+		memmove(destVals + destPos + count, destVals + destPos, destTail * sizeof(ValType));
+		memcpy(destKeys + destPos, keys + first, count * sizeof(KeyType));
+		memcpy(destVals + destPos, vals + first, count * sizeof(ValType));
+
+		int tail = numOfSlots - first - count;
+		memmove(keys + first, keys + first + count, tail * sizeof(KeyType));
+		memmove(vals + first, vals + first + count, tail * sizeof(ValType));
+
+		destPage->numOfSlots += count;
+		destPage->freeSpace -= count * (sizeof(KeyType) + sizeof(ValType));
+		numOfSlots -= count;
+		freeSpace += count * (sizeof(KeyType) + sizeof(ValType));
+	}
+
+
+	//-------------------------------------------------------------------
+	// FixedKVPage::PrintPage
+	//
+	// Input   : None.
+	// Output  : None.
+	// Return  : None.
+	// Purpose : Prints the entries on this page.
+	//-------------------------------------------------------------------
+	void PrintPage() {
+		std::cout << "page_id: " << pid << " type: "
+			      << ((GetType() == 0/*INDEX_PAGE*/) ? "INDEX_PAGE" : "LEAF_PAGE")
+				  << " numEntries: " << numOfSlots << std::endl;
+		for(int i = 0; i < numOfSlots; i++) {
+			std::cout << GetKey(i) << "[" << GetValue(i) << "]" << std::endl;
+		}
+	}
+};
+
+#endif
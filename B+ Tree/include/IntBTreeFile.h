@@ -0,0 +1,98 @@
+#ifndef _INT_B_TREE_FILE_H_
+#define _INT_B_TREE_FILE_H_
+
+#include "BTreeheaderPage.h"
+#include "IntBTreeFileScan.h"
+#include "BTreeInclude.h"
+#include "BulkLoadSource.h"
+#include "BTreeCore.h"
+
+#include <vector>
+
+//-------------------------------------------------------------------
+// IntKeyTraits
+//
+// The page operations BTreeCore needs for 64-bit integer keys on 
+// FixedKVPages (IntIndexPage and IntLeafPage), which store keys as 
+// integers in fixed-width entries, so there is no string formatting, no
+// slot array and each key compare is a single integer compare. Pages are
+// split, merged and filled by entry counts, and entries move in block 
+// copies.
+//-------------------------------------------------------------------
+struct IntKeyTraits {
+	typedef IntKey KeyArg;
+	typedef IntKey Key;
+	typedef IntIndexPage IndexPageType;
+	typedef IntLeafPage LeafPageType;
+	typedef IntBulkLoadSource SourceType;
+
+	static int Compare(IntKey a, IntKey b) { return (a < b) ? -1 : (b < a) ? 1 : 0; }
+	static void CopyKey(IntKey& dest, IntKey src) { dest = src; }
+	static bool KeyFits(IntKey key) { return true; }
+
+	// The first key of the right page separates the two.
+	static void Separator(IntKey leftMax, IntKey rightMin, IntKey& separator) { separator = rightMin; }
+
+	// Index entries have a fixed size, so a new separator always fits
+	// where the old one was.
+	static bool HasRoomForSeparator(IntIndexPage* parent) { return true; }
+
+	// True once the page holds its share of entries.
+	template<typename PageType>
+	static bool PageFilled(PageType* page, double fillFactor) {
+		return page->GetNumEntries() >= PageType::CAPACITY * fillFactor;
+	}
+
+	// True if less than DELETE_MIN_FILL of the page is in use.
+	template<typename PageType>
+	static bool PageUnderflows(PageType* page) {
+		return page->GetNumEntries() < PageType::CAPACITY * DELETE_MIN_FILL;
+	}
+
+	static void IntKeyTraits::InitLeaf(IntLeafPage* page, PageID pid, BTreeHeaderPage* header);
+	static PageID IntKeyTraits::FindChild(IntIndexPage* indexPage, IntKey key, bool strict);
+	static void IntKeyTraits::GetChildren(IntIndexPage* indexPage, std::vector<PageID>& children);
+	static int IntKeyTraits::FindKeyChildren(IntIndexPage* indexPage, IntKey key, PageID *children, int maxChildren);
+	static bool IntKeyTraits::FindSiblings(IntIndexPage* parent, PageID childPid, PageID& leftPid, PageID& rightPid, IntKey& sep);
+	static Status IntKeyTraits::SplitLeafEntries(IntLeafPage* oldPage, IntLeafPage* newPage, IntKey key, const RecordID rid);
+	static void IntKeyTraits::LeafSeparator(IntLeafPage* oldPage, IntLeafPage* newPage, IntKey& separator);
+	static Status IntKeyTraits::SplitIndexEntries(IntIndexPage* oldPage, IntIndexPage* newPage, IntKey key, PageID pid,
+	                                              PageID leftPid, IntKey& upKey);
+	static Status IntKeyTraits::GetLastEntry(IntIndexPage* indexPage, IntKey& key, PageID& pid);
+	static bool IntKeyTraits::LeavesFit(IntLeafPage* left, IntLeafPage* right, IntLeafPage* merged);
+	static void IntKeyTraits::MergeLeaves(IntLeafPage* left, IntLeafPage* right, IntLeafPage* merged);
+	static bool IntKeyTraits::IndexPagesFit(IntIndexPage* left, IntKey sep, IntIndexPage* right, IntIndexPage* merged);
+	static void IntKeyTraits::MergeIndexPages(IntIndexPage* left, IntKey sep, IntIndexPage* right, IntIndexPage* merged);
+	static void IntKeyTraits::RedistributeLeaves(IntLeafPage* left, IntLeafPage* right, IntKey& newSep);
+	static void IntKeyTraits::RedistributeIndexPages(IntIndexPage* left, IntKey sep, IntIndexPage* right, IntKey& newSep);
+};
+
+//-------------------------------------------------------------------
+// IntBTreeFile
+//
+// A B+ tree over 64-bit integer keys. Inserts, deletes and loading are
+// shared with BTreeFile through BTreeCore; this class adds the searches
+// and scans over IntLeafPages.
+//-------------------------------------------------------------------
+class IntBTreeFile : public BTreeCore<IntKeyTraits> {
+
+public:
+	friend class BTreeDriver;
+
+	IntBTreeFile(Status& status, const char *filename);
+
+	IntBTreeFileScan* OpenScan(const IntKey* lowKey, const IntKey* highKey);
+
+	Status Lookup(IntKey key, RecordID *rids, int maxRids, int& numRids);
+
+	Status PrintWhole();
+
+private:
+
+	Status IntBTreeFile::FindLeaf(IntKey key, bool strict, PageGuard& leafGuard, IntLeafPage*& leafPage);
+	Status IntBTreeFile::PrintTree(PageID pageID);
+
+};
+
+
+#endif
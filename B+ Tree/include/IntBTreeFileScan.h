@@ -0,0 +1,37 @@
+#ifndef _INT_BTREE_FILESCAN_H
+#define _INT_BTREE_FILESCAN_H
+
+#include "BTreeInclude.h"
+
+class IntBTreeFileScan {
+
+public:
+	friend class IntBTreeFile;
+
+	// Retrieves the next (key, value) pair in the tree.
+	Status GetNext(RecordID & rid, IntKey& key);
+
+	// Deletes the key value pair most recently returned from 
+	// GetNext. Leaf pages are not merged or redistributed.
+	Status DeleteCurrent();
+
+	~IntBTreeFileScan();
+
+private:
+
+	IntBTreeFileScan();
+
+	bool hasLowKey; // whether the scan starts at lowKey or at the first key
+	bool hasHighKey; // whether the scan ends at highKey or at the last key
+	IntKey lowKey; // min key in scan
+	IntKey highKey; // max key in scan
+	IntLeafPage* currentPage; // page that scan is currently on
+	PageGuard pageGuard; // holds the pin on currentPage until the scan moves on or is done
+	int currentPos; // position of the next entry on the current page
+	bool done; // true when scan is done
+
+	Status IntBTreeFileScan::_EndScan(); // releases the current page once the scan is done
+
+};
+
+#endif
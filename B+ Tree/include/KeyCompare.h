@@ -0,0 +1,21 @@
+#ifndef _KEY_COMPARE_H_
+#define _KEY_COMPARE_H_
+
+#include <string.h>
+
+#include "minirel.h"
+
+// Compares two NUL-terminated keys. The sign of the result matches
+// strcmp(a, b). glibc's strcmp already compares 16 or more bytes per
+// step, and hand-written SSE2 and AVX2 kernels were no faster for 20 to
+// 60 byte keys, so this is strcmp; Test 7 times it against a byte loop.
+inline int KeyCompare(const char* a, const char* b) {
+	return strcmp(a, b);
+}
+
+// Compares key against numKeys keys that are sorted in ascending order.
+// Returns the number of keys smaller than key, and sets found if the
+// next key equals it.
+int KeySearch(const char* key, const char* const* keys, int numKeys, bool& found);
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef _PAGE_GUARD_H_
+#define _PAGE_GUARD_H_
+
+#include "minirel.h"
+#include "bufmgr.h"
+#include "system_defs.h"
+
+//-------------------------------------------------------------------
+// PageGuard
+//
+// Holds the pin on one page and unpins it when the guard goes out of
+// scope, so a function that returns early on an error can't leave the
+// page pinned. The page is unpinned dirty if SetDirty was called, or if
+// the guard allocated it.
+//-------------------------------------------------------------------
+class PageGuard {
+
+public:
+	PageGuard() : pid(INVALID_PAGE), dirty(false) {}
+
+	~PageGuard() {
+		Release();
+	}
+
+	// Pins pageNo, releasing any page held before.
+	template<typename PageType>
+	Status Pin(PageID pageNo, PageType*& page) {
+		Release();
+		Status s = MINIBASE_BM->PinPage(pageNo, (Page*&) page);
+		if(s == OK) {
+			pid = pageNo;
+			dirty = false;
+		}
+		return s;
+	}
+
+	// Allocates a new page, releasing any page held before.
+	template<typename PageType>
+	Status New(PageID& pageNo, PageType*& page) {
+		Release();
+		Status s = MINIBASE_BM->NewPage(pageNo, (Page*&) page);
+		if(s == OK) {
+			pid = pageNo;
+			dirty = true;
+		}
+		return s;
+	}
+
+	// Marks the page as modified.
+	void SetDirty() {
+		dirty = true;
+	}
+
+	// Unpins the page now, rather than when the guard goes out of scope.
+	Status Release() {
+		if(pid == INVALID_PAGE) {
+			return OK;
+		}
+		PageID pageNo = pid;
+		pid = INVALID_PAGE;
+		return MINIBASE_BM->UnpinPage(pageNo, dirty);
+	}
+
+	// Gives up the pin without unpinning, for when another function
+	// takes over the page, e.g. to unpin and free it.
+	void Detach() {
+		pid = INVALID_PAGE;
+	}
+
+	PageID PageNo() {
+		return pid;
+	}
+
+private:
+	PageID pid;
+	bool dirty;
+
+	// A pin has exactly one owner.
+	PageGuard(const PageGuard&);
+	PageGuard& operator=(const PageGuard&);
+};
+
+#endif
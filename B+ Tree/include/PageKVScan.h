@@ -13,14 +13,27 @@ private:
 	bool toInit;
 	char* curKey;
 
+	// The current record, and the length of the key stored in it. 
+	// On prefix compressed pages the stored key is only the suffix,
+	// and curKey points to the full key rebuilt in keyBuf.
+	char* curRec;
+	int keyLength;
+	char keyBuf[MAX_KEY_LENGTH];
+
 	// Private method that initializes the iterator to the 
 	// first value of the key in the record rid. 
 	void setKey(RecordID rid, bool prev = false) {
 		int recLen;
-		page->ReturnRecord(rid, curKey, recLen);
+		page->ReturnRecord(rid, curRec, recLen);
 
-		int keyLength = strlen(curKey) + 1;
-		//curVal = (ValType*)(curKey + keyLength);
+		keyLength = strlen(curRec) + 1;
+		if(page->IsPrefixCompressed()) {
+			page->ExpandKey(curRec, keyBuf);
+			curKey = keyBuf;
+		}
+		else {
+			curKey = curRec;
+		}
 
 		assert(((recLen - keyLength) % sizeof(ValType)) == 0);
 		numValsWithKey = (recLen - keyLength) / sizeof(ValType);
@@ -51,8 +64,8 @@ private:
 	}
 
 
-	ValType GetVal(char* key, int valNum) {
-		return *((ValType*)(curKey + strlen(key) + 1 + valNum * sizeof(ValType)));
+	ValType GetVal(int valNum) {
+		return *((ValType*)(curRec + keyLength + valNum * sizeof(ValType)));
 	}
 
 public:
@@ -99,7 +112,7 @@ public:
 			curValNum++;
 		}
 		key = curKey;
-		val = GetVal(curKey, curValNum);
+		val = GetVal(curValNum);
 		return OK;
 	}
 
@@ -147,7 +160,7 @@ public:
 			curValNum--;
 		}
 		key = curKey;
-		val = GetVal(curKey, curValNum);
+		val = GetVal(curValNum);
 		return OK;
 
 	}
@@ -166,7 +179,7 @@ public:
 	// Purpose : Deletes the "current" key-value pair, i.e. the one returned 
 	// 	         by the last call to GetNext or GetPrev. After this has been called. 
 	//           The "cursor" will be reset to immediately before the deleted 
-	//           keyValue pair.
+	//           keyValue pair, so that GetNext returns the pair that followed it.
 	//-------------------------------------------------------------------
 	Status DeleteCurrent() {
 		if(toInit || curKey == NULL || page->IsEmpty()) {
@@ -174,19 +187,38 @@ public:
 		}
 
 		char* keyToDelete = curKey;
-		ValType valToDelete = GetVal(curKey, curValNum);
+		ValType valToDelete = GetVal(curValNum);
+
+		// Whether the whole record goes away, and which value of the 
+		// record follows the deleted one if it does not.
+		bool removesKey = (numValsWithKey == 1);
+		int nextValNum = curValNum;
+
+		if(page->Delete(keyToDelete, valToDelete) == FAIL) {
+			return FAIL;
+		}
+
+		// Move the cursor to the pair that followed the deleted one, so the 
+		// next call to GetNext returns it. When the key was removed, its slot
+		// now holds the following key. When the key's last value was cut, 
+		// the following pair is the first value of the next key.
+		if(removesKey) {
+			nextValNum = 0;
+		}
+		else if(nextValNum == numValsWithKey - 1) {
+			curRid.slotNo++;
+			nextValNum = 0;
+		}
 
-		if(curRid.slotNo == 0 && page->GetNumOfRecords() == 1 && numValsWithKey == 1) {
+		if(page->IsEmpty() || curRid.slotNo >= page->GetNumOfRecords()) {
 			curKey = NULL;
 		}
 		else {
+			setKey(curRid);
+			curValNum = nextValNum;
 			toInit = true;
 		}
 
-		if(page->Delete(keyToDelete, valToDelete) == FAIL) {
-			return FAIL;
-		}
-
 		return OK;
 	}
 };
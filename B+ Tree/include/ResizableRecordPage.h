@@ -3,6 +3,10 @@
 
 #include "heappage.h"
 
+// Flag or'ed into the page type of pages that store one common key prefix 
+// for the whole page, followed by per-record key suffixes.
+#define PREFIX_COMPRESSED_PAGE 0x100
+
 class ResizableRecordPage : public HeapPage {
 public:
 	// Appends data to an existing record, 
@@ -23,7 +27,8 @@ public:
 
 	// Accessor methods.
 	void  SetType(short t)  { type = t; }
-	short GetType()         { return type; }
+	short GetType()         { return type & ~PREFIX_COMPRESSED_PAGE; }
+	bool  IsPrefixCompressed() { return (type & PREFIX_COMPRESSED_PAGE) != 0; }
 	int   GetNumOfRecords() { return numOfSlots; }
 
 
@@ -2,12 +2,166 @@
 #define _SORTED_KV_PAGE_
 
 #include "ResizableRecordPage.h"
+
+// Longest key that can be stored on a page, including the terminating NUL.
+#define MAX_KEY_LENGTH 128
+
 #include "PageKVScan.h"
+#include "KeyCompare.h"
+
+// FindKey binary searches until at most this many slots are left, then
+// hands them to KeySearch.
+#define KEY_SEARCH_WINDOW 4
 
 template<typename ValType>
 class SortedKVPage : public ResizableRecordPage {
 
+	// PageKVScan expands keys stored on prefix compressed pages.
+	friend class PageKVScan<ValType>;
+
 private:
+	//-------------------------------------------------------------------
+	// Prefix compressed pages
+	//
+	// A page initialized with prefixCompressed set keeps the prefix that 
+	// all of its keys share at the start of the data area, as one length 
+	// byte followed by the prefix bytes. Each record then only stores the
+	// rest of its key (the suffix), followed by the array of values:
+	//
+	//     [len][prefix ...][suffix\0 vals ...][suffix\0 vals ...] ...
+	//
+	// The prefix is set to the first key inserted into an empty page and 
+	// is shortened (rewriting every record) when a key that does not 
+	// share it is inserted. Pages without the flag store full keys and 
+	// have a prefix length of 0.
+	//-------------------------------------------------------------------
+
+	// Returns the length of the prefix shared by all keys on this page.
+	int GetPrefixLength() {
+		return IsPrefixCompressed() ? (unsigned char) data[0] : 0;
+	}
+
+	// Returns a pointer to the (not NUL-terminated) page prefix.
+	char* GetPrefix() {
+		return data + 1;
+	}
+
+	// Returns the key stored in the given slot, without the page prefix.
+	char* GetStoredKey(int slotNo) {
+		return data + (GetFirstSlotPointer() - slotNo)->offset;
+	}
+
+	// Rebuilds a full key from a key stored on this page.
+	void ExpandKey(const char* storedKey, char* key) {
+		int prefixLength = GetPrefixLength();
+		memcpy(key, GetPrefix(), prefixLength);
+		strcpy(key + prefixLength, storedKey);
+	}
+
+
+	//-------------------------------------------------------------------
+	// SortedKVPage::ResetPrefix
+	//
+	// Input   : prefix, the new page prefix. 
+	//           length, the length of the new prefix. 
+	// Output  : None.
+	// Return  : None.
+	// Purpose : Empties this prefix compressed page and sets its prefix.
+	//-------------------------------------------------------------------
+	void ResetPrefix(const char* prefix, int length) {
+		assert(IsPrefixCompressed() && length < MAX_KEY_LENGTH);
+		numOfSlots = 1;
+		SetSlotEmpty(GetFirstSlotPointer() - 0);
+
+		data[0] = (char) length;
+		if(length > 0) {
+			memmove(GetPrefix(), prefix, length);
+		}
+		freePtr = 1 + length;
+		freeSpace = HEAPPAGE_DATA_SIZE - sizeof(Slot) - freePtr;
+	}
+
+
+	//-------------------------------------------------------------------
+	// SortedKVPage::CommonPrefixLength
+	//
+	// Input   : key, the key to compare with the page prefix.
+	// Output  : None.
+	// Return  : The number of leading bytes key shares with the page prefix.
+	//-------------------------------------------------------------------
+	int CommonPrefixLength(const char* key) {
+		int prefixLength = GetPrefixLength();
+		char* prefix = GetPrefix();
+		int i = 0;
+		while(i < prefixLength && key[i] == prefix[i]) {
+			i++;
+		}
+		return i;
+	}
+
+
+	//-------------------------------------------------------------------
+	// SortedKVPage::ShrinkPrefix
+	//
+	// Input   : newLength, the new length of the page prefix. Must not be
+	//                      larger than the current length. 
+	// Output  : None.
+	// Return  : None.
+	// Purpose : Shortens the page prefix, moving the bytes dropped from it
+	//           to the front of the key stored in every record. The caller
+	//           must make sure there is enough space on the page. 
+	//-------------------------------------------------------------------
+	void ShrinkPrefix(int newLength) {
+		int oldLength = GetPrefixLength();
+		assert(newLength <= oldLength);
+		assert(freeSpace >= (oldLength - newLength) * (numOfSlots - 1));
+
+		// Save a copy of the page so the records can be rewritten in place.
+		char saved[HEAPPAGE_DATA_SIZE];
+		memcpy(saved, data, HEAPPAGE_DATA_SIZE);
+		int numRecords = numOfSlots;
+		Slot* savedSlots = (Slot*)(saved + HEAPPAGE_DATA_SIZE - sizeof(Slot));
+
+		ResetPrefix(saved + 1, newLength);
+
+		char recPtr[HEAPPAGE_DATA_SIZE];
+		int moved = oldLength - newLength;
+		memcpy(recPtr, saved + 1 + newLength, moved);
+
+		for(int i = 0; i < numRecords; i++) {
+			Slot* slot = savedSlots - i;
+			memcpy(recPtr + moved, saved + slot->offset, slot->length);
+
+			RecordID rid;
+			Status s = HeapPage::InsertRecord(recPtr, moved + slot->length, rid);
+			assert(s == OK && rid.slotNo == i);
+		}
+	}
+
+
+	//-------------------------------------------------------------------
+	// SortedKVPage::SpaceForNewKey
+	//
+	// Input   : key, a key that is not yet on this page. 
+	// Output  : None.
+	// Return  : The number of bytes, not counting the slot, needed to 
+	//           insert a new record for key with a single value.
+	// Purpose : Computes the size of a new record. On prefix compressed 
+	//           pages this includes the growth of the existing records 
+	//           if the page prefix has to be shortened to fit key. 
+	//-------------------------------------------------------------------
+	int SpaceForNewKey(const char* key) {
+		int recSize = strlen(key) + 1 + sizeof(ValType);
+		if(!IsPrefixCompressed() || IsEmpty()) {
+			return recSize;
+		}
+
+		int common = CommonPrefixLength(key);
+		int growth = (GetPrefixLength() - common) * (numOfSlots - 1);
+		return recSize - common + growth;
+	}
+
+
 	//-------------------------------------------------------------------
 	// SortedKVPage::FindKey
 	//
@@ -18,45 +172,78 @@ private:
 	//                largest key smaller than the search key.
 	//           FAIL if there is no key on this page smaller than the search key.
 	// Purpose : Private search function to locate keys. External callers should 
-	// 	         use SortedKVPage::Search.
+	// 	         use SortedKVPage::Search. The slot array is kept in key order,
+	//           so this is a binary search over the slots.
 	//-------------------------------------------------------------------
 	Status FindKey(const char* key, RecordID& rid) {
 		// The page is empty if it contains only one empty slot.
 		if(numOfSlots == 1 && SlotIsEmpty(GetFirstSlotPointer())) {
 			return FAIL;
 		}
-		
-		char* firstKey;
-		// There is no first key, so the page is empty.
-		if(GetMinKey(firstKey) == FAIL) {
-			return FAIL;
-		}
-		// The search key is smaller than all keys on this page. 
-		else if(strcmp(firstKey, key) > 0) {
-			return FAIL; 
-		}
 
 		rid.pageNo = pid;
-		for (int i = 0; i < numOfSlots; i++) {
-			assert(!SlotIsEmpty(GetFirstSlotPointer() - i));
 
-			Slot* slot = GetFirstSlotPointer() - i;
+		// Every key on a prefix compressed page starts with the page 
+		// prefix, so a key that does not is smaller or larger than all 
+		// of them. Otherwise only the suffixes need to be compared. 
+		int prefixLength = GetPrefixLength();
+		if(prefixLength > 0) {
+			int cmp = strncmp(key, GetPrefix(), prefixLength);
+			if(cmp < 0) {
+				return FAIL;
+			}
+			else if(cmp > 0) {
+				rid.slotNo = numOfSlots - 1;
+				return DONE;
+			}
+			key += prefixLength;
+		}
 
-			const char* str = data + slot->offset;
+		int low = 0;
+		int high = numOfSlots - 1;
+		while(high - low + 1 > KEY_SEARCH_WINDOW) {
+			int mid = (low + high) / 2;
+			Slot* slot = GetFirstSlotPointer() - mid;
+			assert(!SlotIsEmpty(slot));
+
+			int cmp = KeyCompare(data + slot->offset, key);
 
 			// We find the key directly.
-			if(strcmp(str, key) == 0) {
-				rid.slotNo = i;
+			if(cmp == 0) {
+				rid.slotNo = mid;
 				return OK;
 			}
-			// When we see a key larger than the search key, then we set 
-			// rid to point to previous key and return DONE.
-			else if(strcmp(str, key) > 0) {
-				rid.slotNo = i - 1;
-				return DONE;
+			else if(cmp < 0) {
+				low = mid + 1;
 			}
+			else {
+				high = mid - 1;
+			}
+		}
+
+		// Finish the last few slots with one KeySearch call.
+		const char* keys[KEY_SEARCH_WINDOW];
+		int numKeys = high - low + 1;
+		for(int i = 0; i < numKeys; i++) {
+			Slot* slot = GetFirstSlotPointer() - (low + i);
+			assert(!SlotIsEmpty(slot));
+			keys[i] = data + slot->offset;
+		}
+
+		bool found;
+		int smaller = KeySearch(key, keys, numKeys, found);
+		if(found) {
+			rid.slotNo = low + smaller;
+			return OK;
+		}
+		high = low + smaller - 1;
+
+		// high is now the largest key smaller than the search key.
+		// The search key is smaller than all keys on this page.
+		if(high < 0) {
+			return FAIL;
 		}
-		rid.slotNo = numOfSlots - 1;
+		rid.slotNo = high;
 		return DONE;
 	}
 
@@ -101,6 +288,7 @@ private:
 
 		// Print the key
 		char* start = data + slot->offset;
+		std::cout.write(GetPrefix(), GetPrefixLength());
 		std::cout << start << "[";
 
 		// Print the array of values. Note that this assume that ValType 
@@ -139,16 +327,40 @@ private:
 		std::cout << "prevPage: "; PrintPID(prevPage); std::cout << " ";
 		std::cout << "nextPage: "; PrintPID(nextPage); std::cout << std::endl;
 		std::cout << "numRecords: " << numOfSlots << " freeSpace: " << freeSpace << " ";
-		if(numOfSlots > 0) {
-			Slot* first = GetFirstSlotPointer();
-			Slot* last = GetFirstSlotPointer() - (numOfSlots - 1);
-			std::cout << "minKey: " << (data + first->offset) << " ";
-			std::cout << "maxKey: " << (data + last->offset);
+		char minKey[MAX_KEY_LENGTH];
+		char maxKey[MAX_KEY_LENGTH];
+		if(CopyMinKey(minKey) == OK && CopyMaxKey(maxKey) == OK) {
+			std::cout << "minKey: " << minKey << " ";
+			std::cout << "maxKey: " << maxKey;
+		}
+		if(IsPrefixCompressed()) {
+			std::cout << " prefixLength: " << GetPrefixLength();
 		}
 		std::cout << std::endl;
 	}
 
 
+	//-------------------------------------------------------------------
+	// SortedKVPage::MoveLastValue
+	//
+	// Input   : slotNo, a slot on this page.
+	//           pos, the position the value will have.
+	// Output  : None. 
+	// Return  : None.
+	// Purpose : Moves the last value of the record in slotNo to pos, 
+	//           shifting the values from pos on over by one.
+	//-------------------------------------------------------------------
+	void MoveLastValue(int slotNo, int pos) {
+		Slot* slot = GetFirstSlotPointer() - slotNo;
+		char* rec = data + slot->offset;
+		int keyLength = strlen(rec) + 1;
+		int numVals = (slot->length - keyLength) / sizeof(ValType);
+		ValType* vals = (ValType*)(rec + keyLength);
+
+		ValType val = vals[numVals - 1];
+		memmove(vals + pos + 1, vals + pos, (numVals - 1 - pos) * sizeof(ValType));
+		memcpy(vals + pos, &val, sizeof(ValType));
+	}
 
 
 
@@ -160,13 +372,19 @@ public:
 	// Input   : pid, the PageID of this page.
 	//           indexType, the type of this page 
 	//                      -- whether it is index or leaf.
+	//           prefixCompressed, whether keys on this page share 
+	//                             one stored prefix.
 	// Output  : None. 
 	// Return  : None.
 	// Purpose : Initializes this page the appropriate type.
 	//-------------------------------------------------------------------
-	void Init(PageID pid, short indexType) {
+	void Init(PageID pid, short indexType, bool prefixCompressed = false) {
 		HeapPage::Init(pid);
 		type = indexType;
+		if(prefixCompressed) {
+			type |= PREFIX_COMPRESSED_PAGE;
+			ResetPrefix(NULL, 0);
+		}
 	}
 
 
@@ -177,9 +395,11 @@ public:
 	// Output  : minKey, A pointer to the smallest key on the page.
 	// Return  : OK   if minKey was set correctly.
 	//           FAIL if the page is empty. 
-	// Purpose : Gets the smallest key on the page. 
+	// Purpose : Gets the smallest key on the page. Keys on prefix compressed
+	//           pages are not stored whole; use CopyMinKey for those. 
 	//-------------------------------------------------------------------
 	Status GetMinKey(char*& minKey) {
+		assert(!IsPrefixCompressed());
 		// Page is empty
 		if(IsEmpty()) {
 			return FAIL;
@@ -216,9 +436,11 @@ public:
 	// Output  : maxKey, A pointer to the largest key on the page.
 	// Return  : OK   if maxKey was set correctly.
 	//           FAIL if the page is empty. 
-	// Purpose : Gets the largest key on the page. 
+	// Purpose : Gets the largest key on the page. Keys on prefix compressed
+	//           pages are not stored whole; use CopyMaxKey for those. 
 	//-------------------------------------------------------------------
 	Status GetMaxKey(char*& maxKey) {
+		assert(!IsPrefixCompressed());
 		// Page is empty
 		if(IsEmpty()) {
 			return FAIL;
@@ -240,16 +462,78 @@ public:
 	//           with that key.
 	//-------------------------------------------------------------------
 	Status GetMaxKeyValue(char*& maxKey, ValType& maxVal) {
-		if(IsEmpty()) {
+		if(GetMaxKey(maxKey) == FAIL) {
 			return FAIL;
 		}
 
 		Slot* slot = GetFirstSlotPointer() - (numOfSlots - 1);
-		maxKey = data + slot->offset;
 		maxVal = *((ValType*)(data + slot->offset + slot->length - sizeof(ValType)));
 		return OK;
 	}
 
+	//-------------------------------------------------------------------
+	// SortedKVPage::CopyMinKey
+	//
+	// Input   : None
+	// Output  : minKey, A buffer of at least MAX_KEY_LENGTH bytes that 
+	//                   receives the smallest key on the page.
+	// Return  : OK   if minKey was set correctly.
+	//           FAIL if the page is empty. 
+	// Purpose : Copies the smallest key on the page. Works on both 
+	//           plain and prefix compressed pages.
+	//-------------------------------------------------------------------
+	Status CopyMinKey(char* minKey) {
+		if(IsEmpty()) {
+			return FAIL;
+		}
+		ExpandKey(GetStoredKey(0), minKey);
+		return OK;
+	}
+
+	//-------------------------------------------------------------------
+	// SortedKVPage::CopyMaxKey
+	//
+	// Input   : None
+	// Output  : maxKey, A buffer of at least MAX_KEY_LENGTH bytes that 
+	//                   receives the largest key on the page.
+	// Return  : OK   if maxKey was set correctly.
+	//           FAIL if the page is empty. 
+	// Purpose : Copies the largest key on the page. Works on both 
+	//           plain and prefix compressed pages.
+	//-------------------------------------------------------------------
+	Status CopyMaxKey(char* maxKey) {
+		if(IsEmpty()) {
+			return FAIL;
+		}
+		ExpandKey(GetStoredKey(numOfSlots - 1), maxKey);
+		return OK;
+	}
+
+	//-------------------------------------------------------------------
+	// SortedKVPage::CopyCeilingKey
+	//
+	// Input   : key, the key to search for.
+	// Output  : ceilingKey, A buffer of at least MAX_KEY_LENGTH bytes that 
+	//                       receives the smallest key on the page that is 
+	//                       not less than key.
+	// Return  : OK   if ceilingKey was set.
+	//           DONE if every key on the page is less than key.
+	// Purpose : On an index page, this is the separator that bounds the 
+	//           keys under the child a strict descent for key picks.
+	//-------------------------------------------------------------------
+	Status CopyCeilingKey(const char* key, char* ceilingKey) {
+		int slotNo;
+		if(IsEmpty()) {
+			return DONE;
+		}
+		FindSlot(key, slotNo);
+		if(slotNo >= numOfSlots) {
+			return DONE;
+		}
+		ExpandKey(GetStoredKey(slotNo), ceilingKey);
+		return OK;
+	}
+
 	
 
 
@@ -268,21 +552,36 @@ public:
 	//-------------------------------------------------------------------
 	Status Insert(const char* key, ValType val) {
 		RecordID rid;
-		if(FindKey(key, rid) == OK) {
+		Status findStat = FindKey(key, rid);
+		if(findStat == OK) {
 			if(AvailableSpaceForAppend() < sizeof(ValType)) {
 				return FAIL;
 			}
 
-			//RecordID rid;
 			return AppendToRecord((char*) &val, sizeof(ValType), rid);
-			
 		}
 		else {
-			int recSize = strlen(key) + 1 + sizeof(ValType);
-			if(AvailableSpace() < recSize) {
+			if(AvailableSpace() < SpaceForNewKey(key)) {
 				return FAIL;
 			}
 
+			// The new key goes right after the largest key smaller than it.
+			int insertSlot = (findStat == DONE) ? rid.slotNo + 1 : 0;
+
+			// Only the part of the key after the page prefix is stored. 
+			// An empty page takes the new key as its prefix, otherwise the 
+			// prefix is cut back to the part the new key shares with it.
+			if(IsPrefixCompressed()) {
+				if(IsEmpty()) {
+					ResetPrefix(key, strlen(key));
+				}
+				else if(CommonPrefixLength(key) < GetPrefixLength()) {
+					ShrinkPrefix(CommonPrefixLength(key));
+				}
+				key += GetPrefixLength();
+			}
+			int recSize = strlen(key) + 1 + sizeof(ValType);
+
 			//Create record to pass into insert. 
 			char recPtr[200]; 
 			memcpy(recPtr, key, strlen(key) + 1);
@@ -296,8 +595,8 @@ public:
 			//add it to the appropriate location based on the sort order.
 			assert(rid2.slotNo == numOfSlots - 1);
 
-			//Slot array of length 1 is trivially sorted. 
-			if(numOfSlots == 1) {
+			// The new record already sits in the right slot. 
+			if(insertSlot == rid2.slotNo) {
 				return OK;
 			}
 
@@ -305,31 +604,91 @@ public:
 			int keyOffset = keySlot->offset;
 			int keyLength = keySlot->length;
 
-			for(int i = 0; i < numOfSlots; i++) {
-				Slot* slot = GetFirstSlotPointer() - i;
-				char* keyInSlot = data + slot->offset;
+			// Move this slot and all following slots down one position. 
+			Slot* dest = GetFirstSlotPointer() - (numOfSlots - 1);
+			Slot* src = GetFirstSlotPointer() - (numOfSlots - 2);
 
-				// We've found the location at which to insert the new slot. 
-				if(strcmp(key, keyInSlot) <= 0) {
-					
-					// Move this slot and all following slots down one position. 
-					Slot* dest = GetFirstSlotPointer() - (numOfSlots - 1);
-					Slot* src = GetFirstSlotPointer() - (numOfSlots - 2);
+			// Want to mv all slots, except the last slot and those 
+			// preceding slot insertSlot.
+			int mvLength = (numOfSlots - 1 - insertSlot) * sizeof(Slot);
+			memmove(dest, src, mvLength);
 
-					// Want to mv all slots, except the last slot and those 
-					// preceding slot i.
-					int mvLength = (numOfSlots - 1 - i) * sizeof(Slot);
-					memmove(dest, src, mvLength);
+			// Update slot at appropriate location. 
+			Slot* slot = GetFirstSlotPointer() - insertSlot;
+			slot->offset = keyOffset;
+			slot->length = keyLength;
 
-					// Update slot at appropriate location. 
-					slot->offset = keyOffset;
-					slot->length = keyLength;
+			return OK;
+		}
+	}
 
-					return OK;
-				}
+	//-------------------------------------------------------------------
+	// SortedKVPage::InsertAfter
+	//
+	// Input   : key, the key to insert.
+	//           val, the value to insert. 
+	//           leftVal, the value val should follow.
+	// Output  : None. 
+	// Return  : OK   if the key-value pair was inserted successfully. 
+	//           FAIL if there is no space for the key value pair, 
+	//                or another error occurred.
+	// Purpose : Same as Insert, but if key is already present val is put
+	//           right after leftVal in its record, or first in the record 
+	//           if leftVal is not there. Index pages use this to keep the 
+	//           children of a repeated separator in the order of the tree.
+	//-------------------------------------------------------------------
+	Status InsertAfter(const char* key, ValType val, ValType leftVal) {
+		RecordID rid;
+		if(FindKey(key, rid) != OK) {
+			return Insert(key, val);
+		}
+
+		if(Insert(key, val) != OK) {
+			return FAIL;
+		}
+
+		// val was appended. Shift the values after leftVal over by one. 
+		Slot* slot = GetFirstSlotPointer() - rid.slotNo;
+		char* rec = data + slot->offset;
+		int keyLength = strlen(rec) + 1;
+		int numVals = (slot->length - keyLength) / sizeof(ValType);
+		ValType* vals = (ValType*)(rec + keyLength);
+
+		int pos = 0;
+		for(int i = numVals - 2; i >= 0; i--) {
+			if(vals[i] == leftVal) {
+				pos = i + 1;
+				break;
 			}
 		}
-		return FAIL;
+		MoveLastValue(rid.slotNo, pos);
+		return OK;
+	}
+
+	//-------------------------------------------------------------------
+	// SortedKVPage::InsertFirst
+	//
+	// Input   : key, the key to insert.
+	//           val, the value to insert. 
+	// Output  : None. 
+	// Return  : OK   if the key-value pair was inserted successfully. 
+	//           FAIL if there is no space for the key value pair, 
+	//                or another error occurred.
+	// Purpose : Same as Insert, but if key is already present val is put
+	//           first in its record. Used to move the last value of a key
+	//           to the front of its values on the next page.
+	//-------------------------------------------------------------------
+	Status InsertFirst(const char* key, ValType val) {
+		RecordID rid;
+		if(FindKey(key, rid) != OK) {
+			return Insert(key, val);
+		}
+
+		if(Insert(key, val) != OK) {
+			return FAIL;
+		}
+		MoveLastValue(rid.slotNo, 0);
+		return OK;
 	}
 
 	//-------------------------------------------------------------------
@@ -352,19 +711,25 @@ public:
 
 		Slot* slot = GetFirstSlotPointer() - rid.slotNo;
 
-		int numVals = (slot->length - (strlen(key) + 1)) / sizeof(ValType);
-		ValType* valPtr = (ValType*)(data + slot->offset + strlen(key) + 1);
+		// Length of the key as stored on this page.
+		int keyLength = strlen(data + slot->offset) + 1;
+
+		int numVals = (slot->length - keyLength) / sizeof(ValType);
+		ValType* valPtr = (ValType*)(data + slot->offset + keyLength);
 
 		// The value we are deleting is the only value for this key 
 		// (on this page), so we delete the key as well.
 		if(numVals == 1) {
+			if(!((*valPtr) == val)) {
+				return FAIL;
+			}
 			return DeleteKey(key);
 		}
 
 		//Else iterate through values and cut the one that matches.  
 		for(int i = 0; i < numVals; i++) {
 			if((*valPtr) == val) {
-				return CutFromRecord(strlen(key) + 1 + i*sizeof(ValType), sizeof(ValType), rid);
+				return CutFromRecord(keyLength + i*sizeof(ValType), sizeof(ValType), rid);
 			}
 			valPtr += 1;
 		}
@@ -394,20 +759,23 @@ public:
 
 		// If we deleted the record in the last slot, 
 		// then the slot array was already compacted.
-		if(rid.slotNo == numOfSlots) {
-			return OK;
-		}
-
 		// Otherwise we need to compact slot array. This will change the
 		// record id of records on this page with slots after the slot 
 		// that was deleted!
-		assert(SlotIsEmpty(GetFirstSlotPointer() - rid.slotNo));
-		Slot* mvSource = GetFirstSlotPointer() - (numOfSlots - 1);
-		Slot* mvDest = mvSource + 1;
-		int mvLength = numOfSlots * sizeof(Slot) - ((rid.slotNo + 1) * sizeof(Slot));
-		memmove(mvDest, mvSource, mvLength);
-		numOfSlots--;
-		freeSpace += sizeof(Slot);
+		if(rid.slotNo != numOfSlots) {
+			assert(SlotIsEmpty(GetFirstSlotPointer() - rid.slotNo));
+			Slot* mvSource = GetFirstSlotPointer() - (numOfSlots - 1);
+			Slot* mvDest = mvSource + 1;
+			int mvLength = numOfSlots * sizeof(Slot) - ((rid.slotNo + 1) * sizeof(Slot));
+			memmove(mvDest, mvSource, mvLength);
+			numOfSlots--;
+			freeSpace += sizeof(Slot);
+		}
+
+		// The next key inserted into an empty page picks a new prefix.
+		if(IsPrefixCompressed() && IsEmpty()) {
+			DeleteAll();
+		}
 		return OK;
 	}
 
@@ -423,6 +791,10 @@ public:
 	// Purpose : Deletes all keys on the page, leaving this page empty. 
 	//-------------------------------------------------------------------
 	Status DeleteAll() {
+		if(IsPrefixCompressed()) {
+			ResetPrefix(NULL, 0);
+			return OK;
+		}
 		numOfSlots = 1;
 		freePtr = 0;
 		freeSpace = HEAPPAGE_DATA_SIZE - sizeof(Slot);
@@ -431,6 +803,191 @@ public:
 	}
 
 
+	//-------------------------------------------------------------------
+	// SortedKVPage::FindSplitPoint
+	//
+	// Input   : key, a key that will get a new value once the page is split.
+	//           firstMovesUp, whether the first entry of the upper half 
+	//                         leaves the page, as on index pages.
+	// Output  : slotNo, valNo, the first entry of the upper half of the
+	//                          page: value valNo of the record in slotNo.
+	// Return  : None.
+	// Purpose : Finds the entry that splits the bytes used on this page, 
+	//           counting the new value of key, in half. A record with many
+	//           values (a duplicate key) can be split between its values. 
+	//           Both halves are left non-empty, so the page must hold at 
+	//           least two entries.
+	//-------------------------------------------------------------------
+	void FindSplitPoint(const char* key, int& slotNo, int& valNo, bool firstMovesUp = false) {
+		int keySlot;
+		bool keyPresent = (FindSlot(key, keySlot) == OK);
+		int keyBytes = keyPresent ? sizeof(ValType) : 
+			strlen(key) - CommonPrefixLength(key) + 1 + sizeof(ValType) + sizeof(Slot);
+
+		int total = keyBytes;
+		for(int i = 0; i < numOfSlots; i++) {
+			total += (GetFirstSlotPointer() - i)->length + sizeof(Slot);
+		}
+
+		int bytes = 0;
+		slotNo = numOfSlots;
+		valNo = 0;
+		for(int i = 0; i < numOfSlots; i++) {
+			Slot* slot = GetFirstSlotPointer() - i;
+			int recBytes = slot->length + sizeof(Slot);
+			if(i == keySlot) {
+				if(keyPresent) {
+					recBytes += keyBytes;
+				}
+				else {
+					bytes += keyBytes;
+				}
+			}
+			if(2 * (bytes + recBytes) <= total) {
+				bytes += recBytes;
+				continue;
+			}
+
+			int headerBytes = strlen(data + slot->offset) + 1 + sizeof(Slot);
+			int numVals = GetNumValues(i);
+			if(numVals > 1) {
+				// Both halves of a split record hold its key, so round to 
+				// the value nearest the middle counting the key twice.
+				int vals = ((total + headerBytes) / 2 - bytes - headerBytes + (int) sizeof(ValType) / 2) / (int) sizeof(ValType);
+				valNo = (vals < 0) ? 0 : (vals > numVals ? numVals : vals);
+			}
+			else if(firstMovesUp) {
+				// the record in the middle moves up, leaving the rest balanced
+				valNo = 0;
+			}
+			else {
+				valNo = (2 * bytes + recBytes <= total) ? 1 : 0;
+			}
+			slotNo = i;
+			if(valNo == numVals) {
+				slotNo++;
+				valNo = 0;
+			}
+			break;
+		}
+
+		// keep an entry on each side
+		if(slotNo == 0 && valNo == 0) {
+			if(GetNumValues(0) > 1) {
+				valNo = 1;
+			}
+			else {
+				slotNo = 1;
+			}
+		}
+		else if(slotNo == numOfSlots) {
+			slotNo = numOfSlots - 1;
+			int numVals = GetNumValues(slotNo);
+			valNo = (numVals > 1) ? numVals - 1 : 0;
+		}
+	}
+
+
+	//-------------------------------------------------------------------
+	// SortedKVPage::FindSlot
+	//
+	// Input   : key, the key to search for.
+	// Output  : slotNo, the slot of key if it is on this page, or the slot
+	//                   a new record for it would be inserted at.
+	// Return  : OK   if key is on this page.
+	//           DONE if it is not.
+	//-------------------------------------------------------------------
+	Status FindSlot(const char* key, int& slotNo) {
+		RecordID rid;
+		Status findStat = FindKey(key, rid);
+		if(findStat == FAIL) {
+			slotNo = 0;
+			return DONE;
+		}
+		slotNo = (findStat == OK) ? rid.slotNo : rid.slotNo + 1;
+		return findStat;
+	}
+
+
+	//-------------------------------------------------------------------
+	// SortedKVPage::GetNumValues
+	//
+	// Input   : slotNo, a slot on this page.
+	// Output  : None.
+	// Return  : The number of values in the record stored in slotNo.
+	//-------------------------------------------------------------------
+	int GetNumValues(int slotNo) {
+		Slot* slot = GetFirstSlotPointer() - slotNo;
+		return (slot->length - (strlen(data + slot->offset) + 1)) / sizeof(ValType);
+	}
+
+
+	//-------------------------------------------------------------------
+	// SortedKVPage::CopyEntries
+	//
+	// Input   : src, the page to copy from. Must not be this page.
+	//           firstSlot, firstVal, the first entry of src to copy.
+	//           endSlot, endVal, the entry of src to stop before.
+	// Output  : None.
+	// Return  : None.
+	// Purpose : Replaces the contents of this page with a range of the
+	//           entries of src, keeping the page ID, type and links. The
+	//           records are written back to back in a single pass, so this
+	//           takes time linear in the size of the page. A prefix
+	//           compressed page gets the longest prefix of the copied keys.
+	//-------------------------------------------------------------------
+	void CopyEntries(SortedKVPage* src, int firstSlot, int firstVal, int endSlot, int endVal) {
+		int lastSlot = (endVal > 0) ? endSlot : endSlot - 1;
+
+		DeleteAll();
+		if(firstSlot > lastSlot) {
+			return;
+		}
+
+		// Keys are sorted, so the first and last keys share the prefix
+		// of all keys in between.
+		if(IsPrefixCompressed()) {
+			char firstKey[MAX_KEY_LENGTH];
+			char lastKey[MAX_KEY_LENGTH];
+			src->ExpandKey(src->GetStoredKey(firstSlot), firstKey);
+			src->ExpandKey(src->GetStoredKey(lastSlot), lastKey);
+
+			int length = 0;
+			while(firstKey[length] != '\0' && firstKey[length] == lastKey[length]) {
+				length++;
+			}
+			ResetPrefix(firstKey, length);
+		}
+		int prefixLength = GetPrefixLength();
+
+		int numRecords = 0;
+		for(int i = firstSlot; i <= lastSlot; i++) {
+			Slot* srcSlot = src->GetFirstSlotPointer() - i;
+			char* srcKey = src->data + srcSlot->offset;
+			int srcKeyLength = strlen(srcKey) + 1;
+			int numVals = (srcSlot->length - srcKeyLength) / sizeof(ValType);
+			int fromVal = (i == firstSlot) ? firstVal : 0;
+			int toVal = (i == endSlot) ? endVal : numVals;
+
+			char key[MAX_KEY_LENGTH];
+			src->ExpandKey(srcKey, key);
+			int keyLength = strlen(key + prefixLength) + 1;
+			int valLength = (toVal - fromVal) * sizeof(ValType);
+
+			char* rec = data + freePtr;
+			memcpy(rec, key + prefixLength, keyLength);
+			memcpy(rec + keyLength, srcKey + srcKeyLength + fromVal * sizeof(ValType), valLength);
+			FillSlot(GetFirstSlotPointer() - numRecords, freePtr, keyLength + valLength);
+
+			freePtr += keyLength + valLength;
+			numRecords++;
+		}
+
+		numOfSlots = numRecords;
+		freeSpace = HEAPPAGE_DATA_SIZE - freePtr - numRecords * sizeof(Slot);
+	}
+
+
 	//-------------------------------------------------------------------
 	// SortedKVPage::Search
 	//
@@ -456,6 +1013,85 @@ public:
 	}
 
 
+	//-------------------------------------------------------------------
+	// SortedKVPage::FindLastValue
+	//
+	// Input   : key, the key to search for.
+	//           strict, whether to skip a key equal to the search key.
+	// Output  : val, the last value of the largest key on this page that 
+	//                is smaller than or equal to the search key (only 
+	//                smaller, if strict is set).
+	// Return  : OK   if val was set.
+	//           FAIL if there is no such key on this page.
+	// Purpose : Picks the child to descend to on an index page, without
+	//           opening a scan. 
+	//-------------------------------------------------------------------
+	Status FindLastValue(const char* key, ValType& val, bool strict = false) {
+		RecordID rid;
+		Status findStat = FindKey(key, rid);
+		if(findStat == FAIL) {
+			return FAIL;
+		}
+		if(findStat == OK && strict) {
+			if(rid.slotNo == 0) {
+				return FAIL;
+			}
+			rid.slotNo--;
+		}
+
+		Slot* slot = GetFirstSlotPointer() - rid.slotNo;
+		char* rec = data + slot->offset;
+		memcpy(&val, rec + slot->length - sizeof(ValType), sizeof(ValType));
+		return OK;
+	}
+
+
+	//-------------------------------------------------------------------
+	// SortedKVPage::GetValues
+	//
+	// Input   : key, the key to look up.
+	//           maxVals, the number of values vals has room for.
+	// Output  : vals, the first maxVals values of key on this page.
+	//           numVals, the number of values of key on this page, which
+	//                    may be more than maxVals. 
+	//           reachesEnd, true if no key on this page is larger than 
+	//                       the search key, so values of it may continue 
+	//                       on the next page. 
+	// Return  : OK   if key is on this page.
+	//           DONE if it is not. 
+	// Purpose : Reads the values of a key straight from its record. 
+	//-------------------------------------------------------------------
+	Status GetValues(const char* key, ValType* vals, int maxVals, int& numVals, bool& reachesEnd) {
+		RecordID rid;
+		Status findStat = FindKey(key, rid);
+		numVals = 0;
+
+		if(IsEmpty()) {
+			reachesEnd = true;
+			return DONE;
+		}
+		if(findStat == FAIL) {
+			reachesEnd = false;
+			return DONE;
+		}
+		reachesEnd = (rid.slotNo == numOfSlots - 1);
+		if(findStat != OK) {
+			return DONE;
+		}
+
+		Slot* slot = GetFirstSlotPointer() - rid.slotNo;
+		char* rec = data + slot->offset;
+		int keyLength = strlen(rec) + 1;
+		numVals = (slot->length - keyLength) / sizeof(ValType);
+
+		int toCopy = (numVals < maxVals) ? numVals : maxVals;
+		if(toCopy > 0) {
+			memcpy(vals, rec + keyLength, toCopy * sizeof(ValType));
+		}
+		return OK;
+	}
+
+
 	//-------------------------------------------------------------------
 	// SortedKVPage::Contains
 	//
@@ -476,7 +1112,7 @@ public:
 		char* nextKey;
 		ValType nextVal;
 		while(scan.GetNext(nextKey, nextVal) != DONE) {
-			if(strcmp(key, nextKey) != 0) {
+			if(KeyCompare(key, nextKey) != 0) {
 				return false;
 			}
 			else if(nextVal == val) {
@@ -522,7 +1158,7 @@ public:
 			return (AvailableSpaceForAppend() > sizeof(ValType));
 		}
 		else {
-			return (AvailableSpace() > (int)(strlen(key) + 1 + sizeof(ValType)));
+			return (AvailableSpace() > SpaceForNewKey(key));
 		}
 	}
 
@@ -22,656 +22,536 @@ using namespace std;
 // BTreeFile::BTreeFile
 //
 // Input   : filename - filename of an index.  
+//           prefixCompressLeaves - whether leaf pages of a new index store
+//                                  one common key prefix per page. Ignored
+//                                  when opening an existing index. 
 // Output  : returnStatus - status of execution of constructor. 
-//           OK if successful, FAIL otherwise.
+//           OK if successful, FAIL otherwise. An existing index 
+//           created by IntBTreeFile can't be opened, and its header 
+//           is left unpinned. 
 // Purpose : Open the index file, if it exists. 
 //			 Otherwise, create a new index, with the specified 
-//           filename. You can use 
-//                MINIBASE_DB->GetFileEntry(filename, headerID);
-//           to retrieve an existing index file, and 
-//                MINIBASE_DB->AddFileEntry(filename, headerID);
-//           to create a new one. You should pin the header page
-//           once you have read or created it. You will use the header
-//           page to find the root node. 
-//-------------------------------------------------------------------
-BTreeFile::BTreeFile(Status& returnStatus, const char *filename) {
-	PageID headerID = NULL;
-	Status s = MINIBASE_DB->GetFileEntry(filename, headerID);
-	if (s == FAIL) { // no database header page yet, create it
-		Page *p;
-		returnStatus = MINIBASE_BM->NewPage(headerID, p);
-		if (returnStatus == OK){
-			this->header = (BTreeHeaderPage*)p; 
-			this->header->Init(headerID); 
-			this->header->SetRootPageID(INVALID_PAGE);
-			returnStatus = MINIBASE_DB->AddFileEntry(filename, headerID);
-		}
-	}
-
-	returnStatus = MINIBASE_BM->PinPage(headerID, (Page*&) this->header); // pin the header
-	if (returnStatus != OK) {
-		std::cout << "Unable to pin header page in BTreeFile constructor" << std::endl;
-	}
-
-	this->dbfile = filename;
+//           filename. The header page stays pinned until the index 
+//           is closed, and is used to find the root node. 
+//-------------------------------------------------------------------
+BTreeFile::BTreeFile(Status& returnStatus, const char *filename, bool prefixCompressLeaves)
+	: BTreeCore<StringKeyTraits>(returnStatus, filename, HEADER_KEY_STRING, prefixCompressLeaves) {
 }
 
 
-
 //-------------------------------------------------------------------
-// BTreeFile::~BTreeFile
+// StringKeyTraits::InitLeaf
 //
-// Input   : None 
-// Return  : None
+// Input   : page - the new leaf page
+//           pid - its page ID
+//           header - the header of the index
 // Output  : None
-// Purpose : Free memory and clean Up. You should be sure to 
-//           unpin the header page if it has not been unpinned 
-//           in DestroyFile.
+// Return  : None
+// Purpose : Initializes an empty leaf, prefix compressed if the index is.
 //-------------------------------------------------------------------
-
-BTreeFile::~BTreeFile() {
-	MINIBASE_BM->UnpinPage(((HeapPage*)this->header)->PageNo(), true); // unpin header
-	//_CrtDumpMemoryLeaks();
+void StringKeyTraits::InitLeaf(LeafPage* page, PageID pid, BTreeHeaderPage* header) {
+	page->Init(pid, LEAF_PAGE, header->GetLeafPrefixCompression());
 }
 
 //-------------------------------------------------------------------
-// BTreeFile::DestroyFile
+// StringKeyTraits::FindChild
 //
-// Input   : None
+// Input   : indexPage - the index page to route through
+//           key - the key being searched for
+//           strict - whether to skip separators equal to key
 // Output  : None
-// Return  : OK if successful, FAIL otherwise.
-// Purpose : Free all pages and delete the entire index file. Once you have
-//           freed all the pages, you can use MINIBASE_DB->DeleteFileEntry (dbname)
-//           to delete the database file. 
+// Return  : The child of indexPage that key belongs under.
+// Purpose : Picks the child with the largest key less than or equal to key
+//           (only less, if strict is set), or the leftmost child (the prev 
+//           page) if there is none. When a separator repeats, its children
+//           are kept in tree order and the last one is the only one that can
+//           hold keys larger than it.
 //-------------------------------------------------------------------
-Status BTreeFile::DestroyFile() {
-	cout << "DestroyFile()" << endl;
+PageID StringKeyTraits::FindChild(IndexPage* indexPage, const char *key, bool strict) {
+	PageID childPid;
 
-	PageID rootPid;
-	Status s;
-	rootPid = header->GetRootPageID();
+	// no smaller key on the page, in which case use the prev page pointer
+	if (indexPage->FindLastValue(key, childPid, strict) != OK) {
+		childPid = indexPage->GetPrevPage();
+	}
+	return childPid;
+}
 
-	if (rootPid == INVALID_PAGE) { // no root, done deleting already
-		return OK;
-	} else {
-		s = this->DestroyHelper(rootPid); // recursively delete from root
-		if (s != OK) {
-			cout << "First call to destroy helper failed" << endl;
-			return s;
-		}
-		s = MINIBASE_BM->FreePage(rootPid); // free root
-		if (s != OK) {
-			cout << "Freeing root failed" << endl;
-			return s;
+//-------------------------------------------------------------------
+// StringKeyTraits::GetChildren
+//
+// Input   : indexPage - the index page
+// Output  : children - gets every child of indexPage, leftmost first
+// Return  : None
+//-------------------------------------------------------------------
+void StringKeyTraits::GetChildren(IndexPage* indexPage, std::vector<PageID>& children) {
+	children.push_back(indexPage->GetPrevPage()); // the leftmost child has no key
+
+	PageKVScan<PageID> scan;
+	char *currKey;
+	PageID currPid;
+	if (indexPage->OpenScan(&scan) == OK) {
+		while (scan.GetNext(currKey, currPid) == OK) {
+			children.push_back(currPid);
 		}
-		s = MINIBASE_DB->DeleteFileEntry(this->dbfile); // delete db file
-		return s;
 	}
 }
 
-
 //-------------------------------------------------------------------
-// BTreeFile::DestroyHelper
+// StringKeyTraits::FindKeyChildren
 //
-// Input   : currPid
-// Output  : None
-// Return  : OK if successful, FAIL otherwise.
-// Purpose : Recursively traverse the tre and free all pages along the way.
+// Input   : indexPage - the index page
+//           key - the key being deleted
+//           maxChildren - the number of entries children has room for
+// Output  : children - the children that can hold values of key, in order
+// Return  : The number of children found.
+// Purpose : Values of key can start in the last child with a smaller key
+//           and continue through each child of key itself.
 //-------------------------------------------------------------------
-Status BTreeFile::DestroyHelper(PageID currPid) {
-	ResizableRecordPage* currPage;
-	Status s = OK;
-
-	PIN(currPid, currPage);
-
-	if (currPage->GetType() == INDEX_PAGE) {
-		IndexPage* indexPage = (IndexPage*) currPage;
-		PageKVScan<PageID>* iter = new PageKVScan<PageID>();
-		indexPage->OpenScan(iter);
-
-		char* currKey;
-		PageID currID;
-		Status ds = OK;
+int StringKeyTraits::FindKeyChildren(IndexPage* indexPage, const char *key, PageID *children, int maxChildren) {
+	int numChildren;
+	bool reachesEnd;
+	children[0] = FindChild(indexPage, key, true);
+	if (indexPage->GetValues(key, children + 1, maxChildren - 1, numChildren, reachesEnd) != OK) {
+		numChildren = 0;
+	}
+	return numChildren + 1;
+}
 
-		while (iter->GetNext(currKey, currID) != DONE) {
-			// index page, so recursively call helper on all child pages
-			ds = this->DestroyHelper(currID);
-			if (ds != OK) {
-				cout << "Destroy helper failed" << endl;
-				return ds;
+//-------------------------------------------------------------------
+// StringKeyTraits::FindSiblings
+//
+// Input   : parent - the index page
+//           childPid - a child of parent
+// Output  : leftPid, rightPid - childPid and its right sibling, or its left
+//                               sibling and childPid if it is the last child
+//           sep - a buffer of MAX_KEY_LENGTH bytes that gets the key of 
+//                 rightPid in parent
+// Return  : false if childPid is the only child of parent.
+//-------------------------------------------------------------------
+bool StringKeyTraits::FindSiblings(IndexPage* parent, PageID childPid, PageID& leftPid, PageID& rightPid, char *sep) {
+	leftPid = INVALID_PAGE;
+	rightPid = INVALID_PAGE;
+
+	// walk the children in order to find the siblings of childPid
+	PageID prevPid = parent->GetPrevPage();
+	bool foundChild = (prevPid == childPid);
+	PageKVScan<PageID> scan;
+	char *currKey;
+	PageID currPid;
+
+	if (parent->OpenScan(&scan) == OK) {
+		while (scan.GetNext(currKey, currPid) == OK) {
+			if (foundChild) {
+				// childPid has a right sibling
+				leftPid = childPid;
+				rightPid = currPid;
+				strcpy(sep, currKey);
+				break;
 			}
-			// delete child page after recursively deleting all its children
-			ds = MINIBASE_BM->FreePage(currID);
-			if (ds != OK) {
-				cout << "Free Page failed" << endl;
-				return ds;
+			if (currPid == childPid) {
+				// pair with the left sibling, unless there is a right one
+				foundChild = true;
+				leftPid = prevPid;
+				rightPid = childPid;
+				strcpy(sep, currKey);
 			}
+			prevPid = currPid;
 		}
-
-		delete iter;
-
-		UNPIN(currPid, DIRTY);
-		return s;
-	} else if(currPage->GetType() == LEAF_PAGE) {
-		// will be deleted by parent index page call to recursive method
-		UNPIN(currPid, CLEAN);
-		return s;
-	} else { // should not happen
-		UNPIN(currPid, CLEAN);
-		return FAIL;
 	}
 
-	return s;
+	return rightPid != INVALID_PAGE;
 }
 
-
-
-
-
 //-------------------------------------------------------------------
-// BTreeFile::Insert
+// StringKeyTraits::SplitLeafEntries
 //
-// Input   : key - pointer to the value of the key to be inserted.
-//           rid - RecordID of the record to be inserted.
+// Input   : oldPage - the current (full) page
+//           newPage - the empty page
+//			 key, rid - the key, record ID to be inserted during the split
 // Output  : None
-// Return  : OK if successful, FAIL otherwise.
-// Purpose : Insert an index entry with this rid and key.  
-// Note    : If the root didn't exist, create it.
-//-------------------------------------------------------------------
-Status BTreeFile::Insert(const char *key, const RecordID rid) {
-	PageID rootPid;
-	Status s;
-	rootPid = header->GetRootPageID();
-
-	// If no root page, create one
-	if(rootPid == INVALID_PAGE) {
-
-		LeafPage* leafpage;
-		s = MINIBASE_BM->NewPage(rootPid, (Page*&)leafpage);
-		if(s == OK) {
-			leafpage->Init(rootPid, LEAF_PAGE);
-			leafpage->SetNextPage(INVALID_PAGE);
-			leafpage->SetPrevPage(INVALID_PAGE);
-			s = leafpage->Insert(key,rid); // insert first key, value into root leaf
-
-			//Make this the root page
-			header->SetRootPageID(rootPid);
-			UNPIN(rootPid, DIRTY);
-			return s;
-		} else {
-			return s;
-		}
-	} else { //there is root already
-
-		PageID currPid = rootPid;
-		PageID insertPid = NULL;
-
-		SplitStatus split;
-		char * new_child_key;
-		PageID new_child_pageid;
-
-		// recursively traverse
-		s = this->InsertHelper(currPid, split, new_child_key, new_child_pageid, key, rid);
-
-		// split will propagate up through the split variable above, signaling that the child was split and a
-		// new page was created with new_child_key and new_child_pageid that need to be inserted into the root
-		// page which also needs to be split
-		if (split == NEEDS_SPLIT) {
-
-			ResizableRecordPage* currPage;
-			PIN(rootPid, currPage);
-
-			if (currPage->GetType() == INDEX_PAGE) {
-
-				IndexPage* indexPage = (IndexPage*) currPage;
-
-				IndexPage* newRoot;
-				PageID newRootPid;
-				s = MINIBASE_BM->NewPage(newRootPid, (Page*&)newRoot);
-				if (s != OK) {
-					cout << "Error allocating new root" << endl;
-					return s;
-				}
-				newRoot->Init(newRootPid, INDEX_PAGE);
-				newRoot->SetNextPage(INVALID_PAGE);
-				newRoot->SetPrevPage(INVALID_PAGE);
-
-				char * minKey;
-				Status s2;
-				s2 = indexPage->GetMinKey(minKey);
-				if (s2 != OK) {
-					cout << "Error getting MinKey in Insert split root" << endl;
-					return s2;
-				}
-
-				// insert two children into new root index page
-				s2 = newRoot->Insert(minKey, rootPid);
-				s2 = newRoot->Insert(new_child_key, new_child_pageid);
-				if (s2 != OK) {
-					cout << "Error inserting into new root" << endl;
-					return s2;
-				}
-
-				this->header->SetRootPageID(newRootPid); // update root pid variable
-
-				// update prev page pointer
-				char* minKey2;
-				PageID minVal;
-				newRoot->GetMinKeyValue(minKey2, minVal);
-				newRoot->SetPrevPage(minVal);
-
-				// delete the first entry that is now the prev page pointer
-				PageKVScan<PageID>* iter = new PageKVScan<PageID>();
-				newRoot->OpenScan(iter);
-				iter->GetNext(minKey2, minVal);
-				iter->DeleteCurrent();
-				delete iter;
-
-				UNPIN(rootPid, DIRTY);
-				UNPIN(newRootPid, DIRTY);
-
-				return s;
-
-			} else { // root is leaf page and needs split into index page with two leaf children
-
-				IndexPage* newIndexPage;
-				PageID newIndexPid;
-				s = MINIBASE_BM->NewPage(newIndexPid, (Page*&)newIndexPage);
-				if (s != OK) {
-					cout << "Error allocating new root" << endl;
-					return s;
-				}
-				newIndexPage->Init(newIndexPid, INDEX_PAGE);
-				newIndexPage->SetNextPage(INVALID_PAGE);
-				newIndexPage->SetPrevPage(INVALID_PAGE);
-
-				char * minKey;
-				Status s2;
-				LeafPage* leafPage = (LeafPage*) currPage;
-				s2 = leafPage->GetMinKey(minKey);
-
-				if (s2 != OK) {
-					cout << "Error getting MinKey in Insert split root" << endl;
-					return s2;
-				}
-
-				// insert two pages
-				s2 = newIndexPage->Insert(minKey, rootPid);
-				s2 = newIndexPage->Insert(new_child_key, new_child_pageid);
-
-				if (s2 != OK) {
-					cout << "Error inserting into new root" << endl;
-					return s2;
-				}
-
-				this->header->SetRootPageID(newIndexPid); // update header pid
-
-				// set prev pointer
-				char* minKey2;
-				PageID minVal;
-				newIndexPage->GetMinKeyValue(minKey2, minVal);
-				newIndexPage->SetPrevPage(minVal);
-
-				// need to delete first key value that is now the prev pointer
-				PageKVScan<PageID>* iter = new PageKVScan<PageID>();
-				newIndexPage->OpenScan(iter);
-				iter->GetNext(minKey2, minVal);
-				iter->DeleteCurrent();
-				delete iter;
-
-				UNPIN(newIndexPid, DIRTY);
-				UNPIN(rootPid, DIRTY);
-				return s;
-			}
-		}
+// Return  : OK if successful, FAIL otherwise, in which case oldPage is
+//           restored.
+// Purpose : Split the entries into two and insert the key, rid into the 
+//           correct page. The upper half of the entries by size moves to 
+//           newPage in bulk, in time linear in the size of the page.
+//-------------------------------------------------------------------
+Status StringKeyTraits::SplitLeafEntries(LeafPage* oldPage, LeafPage* newPage, const char *key, const RecordID rid) {
+
+	// Split the entries in half by size. Both pages are rebuilt in one 
+	// pass each from a copy of the full page.
+	LeafPage saved;
+	memcpy(&saved, oldPage, sizeof(LeafPage));
+
+	int splitSlot, splitVal;
+	saved.FindSplitPoint(key, splitSlot, splitVal);
+	oldPage->CopyEntries(&saved, 0, 0, splitSlot, splitVal);
+	newPage->CopyEntries(&saved, splitSlot, splitVal, saved.GetNumOfRecords(), 0);
+
+	// a new key that falls right between the pages goes to the emptier one
+	int keySlot;
+	bool between = (saved.FindSlot(key, keySlot) != OK && keySlot == splitSlot && splitVal == 0);
+	char newMinKey[MAX_KEY_LENGTH];
+	newPage->CopyMinKey(newMinKey);
+	LeafPage* target;
+	if (between) {
+		target = (oldPage->AvailableSpace() > newPage->AvailableSpace()) ? oldPage : newPage;
+	} else {
+		target = (KeyCompare(key, newMinKey) < 0) ? oldPage : newPage;
+	}
+	Status ds = target->Insert(key, rid);
+
+	// A key that shortens the prefix of a compressed page can need more
+	// room than the split freed. Such a key either lies past one end of 
+	// the page or shares the prefix of all its keys, so splitting right 
+	// where it goes and adding it to the emptier side always leaves room.
+	if (ds != OK && newPage->IsPrefixCompressed()) {
+		oldPage->CopyEntries(&saved, 0, 0, keySlot, 0);
+		newPage->CopyEntries(&saved, keySlot, 0, saved.GetNumOfRecords(), 0);
+
+		target = (oldPage->AvailableSpace() > newPage->AvailableSpace()) ? oldPage : newPage;
+		ds = target->Insert(key, rid);
+	}
 
-		if(s != OK) {
-			return s;
-		} else {
-			return OK;
-		}
+	if (ds != OK) {
+		// put the entries back, so newPage can be thrown away
+		memcpy(oldPage, &saved, sizeof(LeafPage));
 	}
+	return ds;
 }
 
 //-------------------------------------------------------------------
-// BTreeFile::InsertHelper
+// StringKeyTraits::LeafSeparator
 //
-// Input   : currPid - the current pid being traversed
-//           st - split status of the current node
-//			 newChildKey - if new sibling was created, fill this and newChildPageID
-//			 key, rid - the key, record ID being inserted
-// Output  : None
-// Return  : OK if successful, FAIL otherwise.
-// Purpose : Recursively traverse the tree to insert an index entry with this rid and key.
-//			 Split if necessary and propagate up to parents.  
+// Input   : oldPage, newPage - the two halves of a split leaf
+// Output  : separator - a buffer of MAX_KEY_LENGTH bytes that gets the
+//                       key to push up for newPage
+// Return  : None
+// Purpose : Pushes up the shortest key that still separates the two leaves.
 //-------------------------------------------------------------------
-Status BTreeFile::InsertHelper(PageID currPid, SplitStatus& st, char*& newChildKey, PageID & newChildPageID, const char *key, const RecordID rid) {
-
-	ResizableRecordPage* currPage;
-	PageID nextPid;
-	Status s = OK;
-	Status s2 = OK;
-
-	SplitStatus split;
-	char * new_child_key;
-	PageID new_child_pageid;
-
-	PIN(currPid, currPage);
-
-	if (currPage->GetType() == INDEX_PAGE) { // current page is an index page
-
-		IndexPage* indexPage = (IndexPage*) currPage;
-		PageKVScan<PageID>* iter = new PageKVScan<PageID>();
-
-		indexPage->Search(key, *iter);
-
-		char * largest_key; // lte key
-
-		// check if done, in which case use the prev page pointer
-		Status s3 = iter->GetNext(largest_key, nextPid);
-		if (s3 != OK) {
-			nextPid = indexPage->GetPrevPage();
-		}
-		PageID largest = nextPid;
-		delete iter;
-
-		// recursive call on next pid
-		s = this->InsertHelper(nextPid, split, new_child_key, new_child_pageid, key, rid);
+void StringKeyTraits::LeafSeparator(LeafPage* oldPage, LeafPage* newPage, char *separator) {
+	char leftMax[MAX_KEY_LENGTH];
+	char rightMin[MAX_KEY_LENGTH];
+	oldPage->CopyMaxKey(leftMax);
+	newPage->CopyMinKey(rightMin);
+	Separator(leftMax, rightMin, separator);
+}
 
-		if (split == NEEDS_SPLIT) {
+//-------------------------------------------------------------------
+// StringKeyTraits::Separator
+//
+// Input   : leftMax - the largest key left on the old leaf after a split
+//           rightMin - the smallest key on the new leaf
+// Output  : separator - the shortest prefix of rightMin that is larger than
+//                       leftMax. Must point to a buffer of MAX_KEY_LENGTH bytes.
+// Return  : None
+// Purpose : Picks the separator to push up after a leaf split. Any key in
+//           (leftMax, rightMin] routes the same keys as rightMin itself, so
+//           the shortest one is used to fit more children on index pages.
+// Note    : Only leaf splits are truncated. The key pushed up by an index
+//           split also bounds the subtrees below it, so it is moved up as is.
+//-------------------------------------------------------------------
+void StringKeyTraits::Separator(const char *leftMax, const char *rightMin, char *separator) {
+	// a key whose values span both leaves cannot be shortened
+	if (KeyCompare(leftMax, rightMin) >= 0) {
+		strcpy(separator, rightMin);
+		return;
+	}
 
-			// child split, insert new child info into this page
+	// keep the common prefix plus the first byte where rightMin is larger
+	int len = 0;
+	while (leftMax[len] != '\0' && leftMax[len] == rightMin[len]) {
+		len++;
+	}
+	len++;
 
-			if (indexPage->Insert(new_child_key, new_child_pageid) != OK) {
+	memcpy(separator, rightMin, len);
+	separator[len] = '\0';
+}
 
-				// no room in current page, split this page and propagate up
+//-------------------------------------------------------------------
+// StringKeyTraits::SplitIndexEntries
+//
+// Input   : oldPage - the current (full) page
+//           newPage - the empty page
+//			 key, pid - the key, child to be inserted during the split
+//			 leftPid - the child pid was split off from. If key repeats, pid
+//			           is placed right after it among the children of key.
+// Output  : upKey - receives the min key to propagate up. Must point to
+//			         a buffer of MAX_KEY_LENGTH bytes.
+// Return  : OK if successful, FAIL otherwise, in which case oldPage is
+//           restored.
+// Purpose : Split the entries into two and insert the key, pid into the 
+//           correct page. As in SplitLeafEntries, entries move to newPage 
+//           in bulk. The min key of newPage moves up and its child becomes
+//           the prev page of newPage.
+//-------------------------------------------------------------------
+Status StringKeyTraits::SplitIndexEntries(IndexPage* oldPage, IndexPage* newPage, const char *key, PageID pid, 
+                                          PageID leftPid, char *upKey) {
+
+	// split the entries in half by size, as in SplitLeafEntries
+	IndexPage saved;
+	memcpy(&saved, oldPage, sizeof(IndexPage));
+
+	int splitSlot, splitVal;
+	saved.FindSplitPoint(key, splitSlot, splitVal, true);
+	oldPage->CopyEntries(&saved, 0, 0, splitSlot, splitVal);
+	newPage->CopyEntries(&saved, splitSlot, splitVal, saved.GetNumOfRecords(), 0);
+
+	// A new key that falls right between the pages goes to the emptier
+	// one. If the children of key were split between the pages, pid goes
+	// to the page holding leftPid, or first among them if neither does.
+	int keySlot;
+	bool between = (saved.FindSlot(key, keySlot) != OK && keySlot == splitSlot && splitVal == 0);
+	char newMinKey[MAX_KEY_LENGTH];
+	newPage->CopyMinKey(newMinKey);
+	int cmp = KeyCompare(key, newMinKey);
+	bool toOld;
+	if (between) {
+		toOld = (oldPage->AvailableSpace() > newPage->AvailableSpace());
+	} else {
+		toOld = (cmp < 0 || (cmp == 0 && oldPage->ContainsKey(key) && !newPage->Contains(key, leftPid)));
+	}
 
-				IndexPage* newIndexPage;
-				PageID newIndexPid;
-				s2 = MINIBASE_BM->NewPage(newIndexPid, (Page*&)newIndexPage);
-				if (s2 != OK) {
-					cout << "Error allocating new index page in InsertHelper split" << endl;
-					return s2;
-				}
-				newIndexPage->Init(newIndexPid, INDEX_PAGE);
-				newIndexPage->SetNextPage(INVALID_PAGE);
-				newIndexPage->SetPrevPage(INVALID_PAGE);
-				char * new_page_key;
-				s2 = this->SplitIndexPage(indexPage, newIndexPage, new_child_key, new_child_pageid, new_page_key);
-				if (s2 != OK) {
-					cout << "Error in Split Index" << endl;
-					return s2;
-				}
+	Status ds = (toOld ? oldPage : newPage)->InsertAfter(key, pid, leftPid);
+	if (ds != OK) {
+		// put the entries back, so newPage can be thrown away
+		memcpy(oldPage, &saved, sizeof(IndexPage));
+		return ds;
+	}
 
-				st = NEEDS_SPLIT; // propagate up a level of recursion
-				newChildKey = new_page_key;
-				newChildPageID = newIndexPid;
+	char* minKey;
+	PageID minVal;
 
-				UNPIN(newIndexPid, DIRTY);
+	// set prev page pointer
+	newPage->GetMinKeyValue(minKey, minVal);
+	newPage->SetPrevPage(minVal);
 
-			}
+	// propagate minKey. It is copied out, since deleting it 
+	// below compacts the page over it.
+	strcpy(upKey, minKey);
 
-			UNPIN(currPid, DIRTY);
-			return s;
-		} else {
-			UNPIN(currPid, CLEAN);
-			return s;
-		}
-	} else if (currPage->GetType() == LEAF_PAGE) {
-		
-		// reached leaf page, insert the key, rid, splitting if necessary
-
-		LeafPage* leafPage = (LeafPage*) currPage;
-		char * maxkey;
-		leafPage->GetMaxKey(maxkey);
-
-		if (leafPage->Insert(key, rid) != OK) {
-			// split this page, propagate up to parent
-			
-			LeafPage* newLeafPage;
-			PageID newLeafPid;
-
-			s2 = MINIBASE_BM->NewPage(newLeafPid, (Page*&)newLeafPage);
-			if (s2 != OK) {
-				cout << "Error allocating new leaf page: "<<newLeafPid<<" in InsertHelper split" << endl;
-				return s2;
-			}
-			newLeafPage->Init(newLeafPid, LEAF_PAGE);
-			newLeafPage->SetNextPage(INVALID_PAGE);
-			newLeafPage->SetPrevPage(INVALID_PAGE);
-
-			s2 = this->SplitLeafPage(leafPage, newLeafPage, key, rid);
-			if (s2 != OK) {
-				cout << "Error in Split Leaf" << endl;
-				return s2;
-			}
+	// delete minKey
+	PageKVScan<PageID> iter;
+	newPage->OpenScan(&iter);
+	iter.GetNext(minKey, minVal);
+	iter.DeleteCurrent();
 
-			st = NEEDS_SPLIT; // propagate up
-			newLeafPage->GetMinKey(newChildKey);
-			newChildPageID = newLeafPid;
+	return ds;
+}
 
-			UNPIN(newLeafPid, DIRTY);
-		}
-		UNPIN(currPid, DIRTY);
-		return s;
-	} else {
-		UNPIN(currPid, CLEAN);
+//-------------------------------------------------------------------
+// StringKeyTraits::GetLastEntry
+//
+// Input   : indexPage - a non-empty index page
+// Output  : key - a buffer of MAX_KEY_LENGTH bytes that gets the last key
+//           pid - the last child of that key
+// Return  : OK if successful, FAIL otherwise.
+//-------------------------------------------------------------------
+Status StringKeyTraits::GetLastEntry(IndexPage* indexPage, char *key, PageID& pid) {
+	if (indexPage->CopyMaxKey(key) != OK) {
 		return FAIL;
 	}
+	return indexPage->FindLastValue(key, pid);
 }
 
 //-------------------------------------------------------------------
-// BTreeFile::SplitLeafPage
+// StringKeyTraits::PageFilled
 //
-// Input   : oldPage - the current (full) page
-//           newPage - the empty page
-//			 key, rid - the key, record ID to be inserted during the split
+// Input   : page - the page being loaded
+//           fillFactor - the fraction of the page to fill
 // Output  : None
-// Return  : OK if successful, FAIL otherwise.
-// Purpose : Split the page into two and insert the key, rid into the correct page 
+// Return  : true once the page holds its share of entries.
 //-------------------------------------------------------------------
-Status BTreeFile::SplitLeafPage(LeafPage* oldPage, LeafPage* newPage, const char *key, const RecordID rid) {
+bool StringKeyTraits::PageFilled(ResizableRecordPage* page, double fillFactor) {
+	return page->AvailableSpace() < HEAPPAGE_DATA_SIZE * (1.0 - fillFactor);
+}
 
-	Status s1 = OK;
-	PageKVScan<RecordID>* oldScan = new PageKVScan<RecordID>();
-	PageKVScan<RecordID>* newScan = new PageKVScan<RecordID>(); // need to cleanup
-	s1 = oldPage->OpenScan(oldScan);
-	if (s1 != OK) {
-		cout << "Error opening scan of oldPage in SplitLeafPage" << endl;
-		return s1;
-	}
+//-------------------------------------------------------------------
+// StringKeyTraits::PageUnderflows
+//
+// Input   : page - the page to check
+// Output  : None
+// Return  : true if less than DELETE_MIN_FILL of the page is in use.
+//-------------------------------------------------------------------
+bool StringKeyTraits::PageUnderflows(ResizableRecordPage* page) {
+	return page->AvailableSpace() > HEAPPAGE_DATA_SIZE * (1.0 - DELETE_MIN_FILL);
+}
 
-	char* currKey;
+//-------------------------------------------------------------------
+// StringKeyTraits::LeavesFit
+//
+// Input   : left, right - adjacent leaves
+// Output  : merged - gets left with the entries of right added, if they fit
+// Return  : true if right can be merged into left.
+// Purpose : Tries the merge on a copy of left, since whether it fits 
+//           depends on the keys (and prefixes) involved.
+//-------------------------------------------------------------------
+bool StringKeyTraits::LeavesFit(LeafPage* left, LeafPage* right, LeafPage* merged) {
+	char *currKey;
 	RecordID currID;
-	Status ds = OK;
-
-	bool insertedNew = false;
+	memcpy(merged, left, sizeof(LeafPage));
+	bool fits = true;
 
-	// move items to new page
-	while (oldScan->GetNext(currKey, currID) != DONE) {
-		ds = newPage->Insert(currKey, currID);
-		if (ds != OK) {
-			std::cout << "SplitLeafPage transfer insert failed" << std::endl;
-			return ds;
+	PageKVScan<RecordID> scan;
+	if (right->OpenScan(&scan) == OK) {
+		while (fits && scan.GetNext(currKey, currID) == OK) {
+			fits = (merged->Insert(currKey, currID) == OK);
 		}
 	}
-	oldPage->DeleteAll();
-	delete oldScan;
-
-	s1 = newPage->OpenScan(newScan);
-	if (s1 != OK) {
-		cout << "Error opening scan of newPage in SplitLeafPage" << endl;
-		return s1;
-	}
-	s1 = newScan->GetNext(currKey, currID);
-	if (s1 != OK) {
-		cout << "Scan GetNext error in SplitLeafPage" << endl;
-		return s1;
-	}
-
-	// move items back while keeping balance
-	while (oldPage->AvailableSpace() > newPage->AvailableSpace()) {		
-		if (strcmp(currKey, key) > 0 && insertedNew == false) { // currKey > key, so put val into oldPage
-			ds = oldPage->Insert(key, rid);
-			insertedNew = true;
-			if (ds != OK) {
-				cout << "Insert new key in split failed SplitLeafPage" << endl;
-				return ds;
-			}
-		} else {
-			ds = oldPage->Insert(currKey, currID);
-			if (ds != OK) {
-				cout << "Moving Page Failed in SplitLeafPage" << endl;
-				return ds;
-			}
-
-			ds = newScan->DeleteCurrent();
-			if (ds != OK) {
-				cout << "Deleting after move page failed in SplitLeafPage" << endl;
-				return ds;
-			}
+	return fits;
+}
 
-			s1 = newScan->GetNext(currKey, currID);
-			if (s1 != OK) {
-				cout << "Scan GetNext error in SplitLeafPage" << endl;
-				return s1;
-			}
-		}
-	}
+//-------------------------------------------------------------------
+// StringKeyTraits::MergeLeaves
+//
+// Input   : left, right - adjacent leaves
+//           merged - the copy LeavesFit built
+// Output  : None
+// Return  : None
+// Purpose : Moves the entries of right into left.
+//-------------------------------------------------------------------
+void StringKeyTraits::MergeLeaves(LeafPage* left, LeafPage* right, LeafPage* merged) {
+	memcpy(left, merged, sizeof(LeafPage));
+}
 
-	delete newScan;
+//-------------------------------------------------------------------
+// StringKeyTraits::IndexPagesFit
+//
+// Input   : left, right - adjacent index pages
+//           sep - the key of right in their parent
+// Output  : merged - gets left followed by sep, the leftmost child of 
+//                    right and the entries of right, if they fit
+// Return  : true if right can be merged into left.
+//-------------------------------------------------------------------
+bool StringKeyTraits::IndexPagesFit(IndexPage* left, const char *sep, IndexPage* right, IndexPage* merged) {
+	char *currKey;
+	PageID currID;
+	memcpy(merged, left, sizeof(IndexPage));
+	bool fits = (merged->Insert(sep, right->GetPrevPage()) == OK);
 
-	// key, rid not inserted during split, insert now
-	if (insertedNew == false) {
-		ds = newPage->Insert(key, rid);
-		if (ds != OK) {
-			cout << "Insert new key after split failed SplitLeafPage" << endl;
-			return ds;
+	PageKVScan<PageID> scan;
+	if (fits && right->OpenScan(&scan) == OK) {
+		while (fits && scan.GetNext(currKey, currID) == OK) {
+			fits = (merged->Insert(currKey, currID) == OK);
 		}
 	}
-
-	// set prev/next pointers
-	PageID oldNextPageID = oldPage->GetNextPage();
-	ResizableRecordPage* oldNextPage;
-	if (oldNextPageID != INVALID_PAGE) {
-		PIN(oldNextPageID, oldNextPage);
-	}
-
-	oldPage->SetNextPage(newPage->PageNo());
-	newPage->SetPrevPage(oldPage->PageNo());
-
-	if (oldNextPageID != INVALID_PAGE) {
-		oldNextPage->SetPrevPage(newPage->PageNo());
-		newPage->SetNextPage(oldNextPageID);
-		UNPIN(oldNextPageID, DIRTY);
-	}
-
-	return ds;
+	return fits;
 }
 
 //-------------------------------------------------------------------
-// BTreeFile::SplitIndexPage
+// StringKeyTraits::MergeIndexPages
 //
-// Input   : oldPage - the current (full) page
-//           newPage - the empty page
-//			 key, rid - the key, record ID to be inserted during the split
-//			 newPageKey - the min key to propagate up
+// Input   : left, right - adjacent index pages
+//           sep - the key of right in their parent
+//           merged - the copy IndexPagesFit built
 // Output  : None
-// Return  : OK if successful, FAIL otherwise.
-// Purpose : Split the page into two and insert the key, rid into the correct page
+// Return  : None
+// Purpose : Moves sep and the children of right into left.
 //-------------------------------------------------------------------
-Status BTreeFile::SplitIndexPage(IndexPage* oldPage, IndexPage* newPage, const char *key, const PageID rid, char *&newPageKey) {
-
-	Status s1 = OK;
+void StringKeyTraits::MergeIndexPages(IndexPage* left, const char *sep, IndexPage* right, IndexPage* merged) {
+	memcpy(left, merged, sizeof(IndexPage));
+}
 
-	PageKVScan<PageID>* oldScan = new PageKVScan<PageID>();
-	PageKVScan<PageID>* newScan = new PageKVScan<PageID>(); //need to cleanup
-	s1 = oldPage->OpenScan(oldScan);
-	if (s1 != OK) {
-		cout << "Error opening scan of oldPage in SplitIndexPage" << endl;
-		return s1;
-	}
+//-------------------------------------------------------------------
+// StringKeyTraits::HasRoomForSeparator
+//
+// Input   : parent - the parent of two pages about to be redistributed
+// Output  : None
+// Return  : true if parent has room for the longest possible separator.
+// Purpose : A redistribution can replace the separator with a longer one.
+//-------------------------------------------------------------------
+bool StringKeyTraits::HasRoomForSeparator(IndexPage* parent) {
+	return parent->AvailableSpace() >= MAX_KEY_LENGTH + (int) sizeof(PageID);
+}
 
-	char* currKey;
-	PageID currID;
-	Status ds = OK;
-	bool insertedNew = false;
-
-	while (oldScan->GetNext(currKey, currID) != DONE) {
-		ds = newPage->Insert(currKey, currID);
-		if (ds != OK) {
-			std::cout << "SplitIndexPage transfer insert failed" << std::endl;
-			return ds;
+//-------------------------------------------------------------------
+// StringKeyTraits::RedistributeLeaves
+//
+// Input   : left, right - adjacent leaves that do not fit on one page
+// Output  : newSep - a buffer of MAX_KEY_LENGTH bytes that gets the new
+//                    separator of right
+// Return  : None
+// Purpose : Moves entries to the emptier leaf until the two are balanced.
+//           The values of a key split across the two leaves keep their 
+//           order: the first value of right's smallest key goes to the 
+//           end of left, and the last value of left's largest key goes 
+//           to the front of right.
+//-------------------------------------------------------------------
+void StringKeyTraits::RedistributeLeaves(LeafPage* left, LeafPage* right, char *newSep) {
+	char moveKey[MAX_KEY_LENGTH];
+	RecordID moveID;
+	if (left->AvailableSpace() > right->AvailableSpace()) {
+		int numVals;
+		bool reachesEnd;
+		while (left->AvailableSpace() > right->AvailableSpace()) {
+			right->CopyMinKey(moveKey);
+			right->GetValues(moveKey, &moveID, 1, numVals, reachesEnd);
+			if (left->Insert(moveKey, moveID) != OK) {
+				break;
+			}
+			right->Delete(moveKey, moveID);
+		}
+	} else {
+		while (right->AvailableSpace() > left->AvailableSpace()) {
+			left->CopyMaxKey(moveKey);
+			left->FindLastValue(moveKey, moveID);
+			if (right->InsertFirst(moveKey, moveID) != OK) {
+				break;
+			}
+			left->Delete(moveKey, moveID);
 		}
 	}
-	oldPage->DeleteAll();
-	delete oldScan;
 
-	s1 = newPage->OpenScan(newScan);
-	if (s1 != OK) {
-		cout << "Error opening scan of newPage in SplitIndexPage" << endl;
-		return s1;
-	}
-	s1 = newScan->GetNext(currKey, currID);
-	if (s1 != OK) {
-		cout << "Scan GetNext error in SplitIndexPage" << endl;
-		return s1;
-	}
+	LeafSeparator(left, right, newSep);
+}
 
-	while (oldPage->AvailableSpace() > newPage->AvailableSpace()) {
-		if (strcmp(currKey, key) > 0 && insertedNew == false) { // currKey > key
-			ds = oldPage->Insert(key, rid);
-			if (ds != OK) {
-				cout << "Insert new key in split failed SplitIndexPage" << endl;
-				return ds;
-			}
-		} else { // currKey < key
-			ds = oldPage->Insert(currKey, currID);
-			if (ds != OK) {
-				cout << "Moving Page Failed in SplitIndexPage" << endl;
-				return ds;
-			}
-			ds = newScan->DeleteCurrent();
-			if (ds != OK) {
-				cout << "Deleting after move page failed in SplitIndexPage" << endl;
-				return ds;
+//-------------------------------------------------------------------
+// StringKeyTraits::RedistributeIndexPages
+//
+// Input   : left, right - adjacent index pages that do not fit on one page
+//           sep - the key of right in their parent
+// Output  : newSep - a buffer of MAX_KEY_LENGTH bytes that gets the new
+//                    separator of right
+// Return  : None
+// Purpose : Moves children to the emptier page through the separator until
+//           the two are balanced.
+//-------------------------------------------------------------------
+void StringKeyTraits::RedistributeIndexPages(IndexPage* left, const char *sep, IndexPage* right, char *newSep) {
+	char *currKey;
+	PageID currID;
+	strcpy(newSep, sep);
+
+	if (left->AvailableSpace() > right->AvailableSpace()) {
+		while (left->AvailableSpace() > right->AvailableSpace()) {
+			// the separator and the leftmost child of right move to left,
+			// the first key of right becomes the separator
+			PageKVScan<PageID> first;
+			if (right->OpenScan(&first) != OK || first.GetNext(currKey, currID) != OK) {
+				break;
 			}
-			s1 = newScan->GetNext(currKey, currID);
-			if (s1 != OK) {
-				cout << "Scan GetNext error in SplitIndexPage" << endl;
-				return s1;
+			if (left->Insert(newSep, right->GetPrevPage()) != OK) {
+				break;
 			}
+			strcpy(newSep, currKey);
+			right->SetPrevPage(currID);
+			right->Delete(newSep, currID);
 		}
-	}
-
-	delete newScan;
-
-	if (insertedNew == false) {
-		ds = newPage->Insert(key, rid);
-		if (ds != OK) {
-			cout << "Insert new key after split failed SplitIndexPage" << endl;
-			return ds;
+	} else {
+		while (right->AvailableSpace() > left->AvailableSpace()) {
+			// the separator comes down as the first key of right, over
+			// its old leftmost child. The last child of left replaces it.
+			char lastKey[MAX_KEY_LENGTH];
+			left->CopyMaxKey(lastKey);
+			left->FindLastValue(lastKey, currID);
+			if (right->InsertAfter(newSep, right->GetPrevPage(), INVALID_PAGE) != OK) {
+				break;
+			}
+			right->SetPrevPage(currID);
+			left->Delete(lastKey, currID);
+			strcpy(newSep, lastKey);
 		}
 	}
-
-	char* minKey;
-	PageID minVal;
-
-	// set prev page pointer
-	newPage->GetMinKeyValue(minKey, minVal);
-	newPage->SetPrevPage(minVal);
-
-	// propagate minKey
-	newPageKey = minKey;
-
-	// delete minKey
-	PageKVScan<PageID>* iter = new PageKVScan<PageID>();
-	newPage->OpenScan(iter);
-	iter->GetNext(minKey, minVal);
-	iter->DeleteCurrent();
-	delete iter;
-
-	return ds;
 }
 
 //-------------------------------------------------------------------
@@ -695,103 +575,134 @@ Status BTreeFile::SplitIndexPage(IndexPage* oldPage, IndexPage* newPage, const c
 //-------------------------------------------------------------------
 BTreeFileScan* BTreeFile::OpenScan(const char* lowKey, const char* highKey) {
 	BTreeFileScan* newScan = new BTreeFileScan();
+	newScan->lowKey = lowKey;
+	newScan->highKey = highKey;
 
 	if (header->GetRootPageID() != INVALID_PAGE) { //found a root
-		PageID lowIndex;
-		Status s;
-
 		if (lowKey == NULL) { // no lower bound so start at left most leaf using given function
-			//initialize scan
-			newScan->done = false;
-			newScan->lowKey = lowKey;
-			newScan->highKey = highKey;
-			newScan->currentPageID = this->GetLeftLeaf();
-		    newScan->_SetIter();
+			newScan->done = (newScan->_SetIter(this->GetLeftLeaf()) != OK);
 			return newScan; 
 		}
-		s = _searchTree(lowKey,  header->GetRootPageID(), lowIndex); //look for page with lowIndex
-		if (s != OK) { //if search fails, initialize scan to done
-			//initialize scan
-			newScan->done = true; 
-			newScan->lowKey = lowKey;
-			newScan->highKey = highKey;
-			newScan->currentPageID = INVALID_PAGE;
-			return newScan;
-		} else{ // found page to start at so initialize scan to that page
-			//initialize scan
-			newScan->done = false;
-			newScan->lowKey = lowKey;
-			newScan->highKey = highKey;
-			newScan->currentPageID = lowIndex;
-		    newScan->_SetIter();
-			return newScan; 
+
+		// look for the page to start at; it is left pinned by the scan's guard
+		LeafPage* leafPage;
+		char upperKey[MAX_KEY_LENGTH];
+		bool bounded;
+		if (_searchTree(lowKey, header->GetRootPageID(), newScan->pageGuard, leafPage, upperKey, bounded) == OK) {
+			newScan->currentPage = leafPage;
+			newScan->done = (newScan->_OpenIter() != OK);
 		}
-	} else { //root not found so just initialize scan to done
-		//initialize scan
-		newScan->done= true;
-		newScan->lowKey = lowKey;
-		newScan->highKey = highKey;
-		newScan->currentPageID = INVALID_PAGE;
-		return newScan;
 	}
+
+	// if there is no root, or the search failed, the scan starts done
+	return newScan;
 }
 
-//function to find leaf page with lowkey or key just before that 
-Status BTreeFile::_searchTree( const char *key,  PageID currentID, PageID& lowIndex)
-{
-    ResizableRecordPage *page;
-	Status s;
-    PIN (currentID, page);
-    if (page->GetType()==INDEX_PAGE) { //current page is index page so call helper function
-		s =	_searchIndexNode(key, currentID, (IndexPage*)page, lowIndex);
-		return s;
-	} else if(page->GetType()==LEAF_PAGE) { //current page is leaf page so store it so it can be used in scan
-		lowIndex = page->PageNo();
-		UNPIN(currentID,CLEAN);
-	} else {
+//-------------------------------------------------------------------
+// BTreeFile::Lookup
+//
+// Input   : key - the key to look up
+//           rids - array to receive the RecordIDs of key
+//           maxRids - the number of entries rids has room for
+// Output  : numRids - the number of RecordIDs key has. Only the first 
+//                     maxRids of them are copied into rids.
+// Return  : OK if key is in the index, DONE if not, FAIL on error.
+// Purpose : Exact match lookup. Descends once, pinning each page on the 
+//           path once, and copies the values straight out of the leaf 
+//           record without opening a scan or allocating memory. 
+// Note    : The descent goes to the leftmost leaf that can hold key, and
+//           walks right only while the values of key run off the end of
+//           a leaf. It does not walk right when the separator above the 
+//           leaf shows that the next leaf starts past key, which a scan
+//           can only find out by pinning that leaf. 
+//-------------------------------------------------------------------
+Status BTreeFile::Lookup(const char *key, RecordID *rids, int maxRids, int& numRids) {
+	numRids = 0;
+
+	PageID rootPid = header->GetRootPageID();
+	if (rootPid == INVALID_PAGE) {
+		return DONE;
+	}
+
+	PageGuard leafGuard;
+	LeafPage* leafPage;
+	char upperKey[MAX_KEY_LENGTH];
+	bool bounded;
+	if (_searchTree(key, rootPid, leafGuard, leafPage, upperKey, bounded) != OK) {
 		return FAIL;
 	}
-	return OK;
+
+	bool found = false;
+	while (true) {
+		int room = (numRids < maxRids) ? maxRids - numRids : 0;
+		RecordID* dest = (room > 0) ? rids + numRids : rids;
+		int numVals;
+		bool reachesEnd;
+
+		if (leafPage->GetValues(key, dest, room, numVals, reachesEnd) == OK) {
+			found = true;
+			numRids += numVals;
+		}
+
+		// every key on the leaves after the one found is at least upperKey
+		PageID nextPid = leafPage->GetNextPage();
+		if (!reachesEnd || nextPid == INVALID_PAGE || (bounded && KeyCompare(key, upperKey) < 0)) {
+			break;
+		}
+		bounded = false;
+		PIN_GUARD(leafGuard, nextPid, leafPage);
+	}
+
+	return found ? OK : DONE;
 }
 
-//function to find the child for an index page that is on path to leaf page with lowkey on it
-Status BTreeFile::_searchIndexNode(const char *key,  PageID currentID, IndexPage *currentIndex, PageID& lowIndex)
+//-------------------------------------------------------------------
+// BTreeFile::_searchTree
+//
+// Input   : key - the key to search for
+//           currentID - the page to start the search at
+// Output  : leafGuard - holds the pin on leafPage for the caller
+//           leafPage - the leftmost leaf page that can hold key
+//           upperKey - a buffer of MAX_KEY_LENGTH bytes that receives the
+//                      smallest separator on the path not less than key.
+//                      Every key on the leaves after leafPage is at least 
+//                      upperKey.
+//           bounded - set if there is such a separator
+// Return  : OK if successful, FAIL otherwise.
+// Purpose : Descends to the leaf page where a scan for key starts. Each
+//           level takes the last child with a key strictly less than key,
+//           since values of key can start in it when a separator equals
+//           key. Only one page is pinned at a time.
+//-------------------------------------------------------------------
+Status BTreeFile::_searchTree(const char *key, PageID currentID, PageGuard& leafGuard, LeafPage*& leafPage, 
+	                          char *upperKey, bool& bounded)
 {
-	PageID nextPid;
-	PageKVScan<PageID>* iter = new PageKVScan<PageID>();
-
-	//search for the key (or the next smallest key) on this page
-	Status s1 = currentIndex->Search(key, *iter);
-
-	char * sk;
-	if (iter->GetNext(sk, nextPid) != OK) { // if no valid key, go to previous page
-		delete iter;
-		nextPid = currentIndex->GetPrevPage();
-		if (nextPid == INVALID_PAGE) {
-			cout << "GetPrevPage on Index Page during scan failed" << endl;
-			return FAIL;
+	ResizableRecordPage *page;
+	bounded = false;
+	PIN_GUARD(leafGuard, currentID, page);
+
+	while (page->GetType() == INDEX_PAGE) {
+		IndexPage* indexPage = (IndexPage*) page;
+		PageID childPid;
+		if (indexPage->FindLastValue(key, childPid, true) != OK) {
+			childPid = indexPage->GetPrevPage();
 		}
-		UNPIN(currentID, CLEAN);
-		Status s = _searchTree(key, nextPid, lowIndex);
-		return s;
-	}
 
-	char * mink;
-	currentIndex->GetMinKey(mink);
-	if (sk == mink) { // if key is first key on page then go back a page
-		PageID prevpage = currentIndex->GetPrevPage();
-		if (prevpage != INVALID_PAGE) {
-			nextPid = prevpage;
+		// the separator after the child is tighter than any above it
+		if (indexPage->CopyCeilingKey(key, upperKey) == OK) {
+			bounded = true;
 		}
-	} else {
-		iter->GetPrev(sk, nextPid);
-	}
 
-	delete iter;
+		currentID = childPid;
+		PIN_GUARD(leafGuard, currentID, page);
+	}
 
-	UNPIN(currentID, CLEAN);
-	Status s = _searchTree(key, nextPid, lowIndex); //return next page in search down tree in nextPid
-	return s;
+	if (page->GetType() != LEAF_PAGE) {
+		leafGuard.Release();
+		return FAIL;
+	}
+	leafPage = (LeafPage*) page;
+	return OK;
 }
 
 //-------------------------------------------------------------------
@@ -846,7 +757,8 @@ PageID BTreeFile::GetLeftLeaf() {
 Status BTreeFile::PrintTree (PageID pageID, bool printContents) {
 
 	ResizableRecordPage* page;
-	PIN(pageID, page);
+	PageGuard guard;
+	PIN_GUARD(guard, pageID, page);
 
 	if(page->GetType() == INDEX_PAGE) {
 		IndexPage* ipage = (IndexPage*) page;
@@ -878,7 +790,6 @@ Status BTreeFile::PrintTree (PageID pageID, bool printContents) {
 		lpage->PrintPage(printContents);
 	}
 
-	UNPIN(pageID, CLEAN);
 	return OK;
 }
 
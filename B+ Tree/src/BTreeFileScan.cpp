@@ -10,11 +10,14 @@
 //
 // Input   : None
 // Output  : None
-// Purpose : Clean Up the B+ tree scan.
+// Purpose : Clean Up the B+ tree scan. A scan that has not finished 
+//           still holds a pin on its current leaf, which pageGuard 
+//           releases.
 //-------------------------------------------------------------------
 BTreeFileScan::~BTreeFileScan ()
 {
-	//Add our code here
+	delete scan;
+	scan = NULL;
 }
 
 
@@ -24,10 +27,12 @@ BTreeFileScan::~BTreeFileScan ()
 // Input   : None
 // Output  : None
 // Purpose : Constructs a new BTreeFileScan object. Note that this constructor
-//           is private and can only be called from 
+//           is private and can only be called from BTreeFile::OpenScan.
 //-------------------------------------------------------------------
 BTreeFileScan::BTreeFileScan() {
-	//Add our code here.
+	done = true;
+	scan = NULL;
+	currentPage = NULL;
 }
 
 //-------------------------------------------------------------------
@@ -39,44 +44,39 @@ BTreeFileScan::BTreeFileScan() {
 // Purpose : Return the next record from the B+-tree index.
 // Return  : OK if successful, DONE if no more records to read
 //           or if high key has been passed.
+// Note    : The current leaf stays pinned from the first entry read on 
+//           it until the scan moves on to the next leaf, so each leaf 
+//           is pinned once rather than once per entry. 
 //-------------------------------------------------------------------
 
 Status BTreeFileScan::GetNext (RecordID & rid, char*& keyPtr)
 {	
-	PIN(currentPageID, currentPage);
-    if(this->done){
-		return DONE;
-    }
-    while (!(this->done)) {
+	while (!(this->done)) {
 		Status s = scan->GetNext(keyPtr, rid); //get next pair on this page
-        if (s!=DONE) {
-			if (this->highKey==NULL||strcmp(keyPtr, this->highKey)<=0) { //within upper bound
-				if(this->lowKey==NULL||strcmp(keyPtr, this->lowKey)>=0) { //within lower bound
-					UNPIN(currentPageID, CLEAN);
-                    return OK;
-                } else {
-					continue; //haven't reached range yet
-                }
-            } else { //exceeded upper bound, so set done
-				this->done = true;
-                rid.pageNo = INVALID_PAGE;
-                rid.slotNo = -1;
-                UNPIN(currentPageID, CLEAN);
-                return DONE;
-            }
-		} else { //done scanning current page, get next page
-			currentPageID = currentPage->GetNextPage();
-            if(currentPageID == INVALID_PAGE){
-				//no more pages
-				this->done = true;
-                UNPIN(currentPage->PageNo(), CLEAN);
-				delete scan;
-                return DONE;
-            }
-			delete scan;
-            UNPIN(currentPage->PageNo(), CLEAN);
-			this->_SetIter();
-			return GetNext(rid, keyPtr); //return the GetNext output on new page
+		if (s != DONE) {
+			if (this->lowKey != NULL && KeyCompare(keyPtr, this->lowKey) < 0) {
+				continue; //haven't reached range yet
+			}
+			if (this->highKey == NULL || KeyCompare(keyPtr, this->highKey) <= 0) { //within range
+				return OK;
+			}
+
+			//exceeded upper bound, so set done
+			rid.pageNo = INVALID_PAGE;
+			rid.slotNo = -1;
+			return _EndScan();
+		}
+
+		//done scanning current page, get next page
+		PageID nextPageID = currentPage->GetNextPage();
+		if (nextPageID == INVALID_PAGE) { //no more pages
+			return _EndScan();
+		}
+		delete scan;
+		scan = NULL;
+		if (this->_SetIter(nextPageID) != OK) {
+			this->done = true;
+			return FAIL;
 		}
 	}
 	return DONE;
@@ -98,18 +98,37 @@ Status BTreeFileScan::DeleteCurrent () {
 	if (done) {
 		return DONE;
 	}
-	PIN(currentPageID, currentPage);
 	Status s = scan->DeleteCurrent(); //use PageKVScan deletecurrent
-	UNPIN(currentPageID, DIRTY);
+	pageGuard.SetDirty(); // the page is unpinned dirty when the scan leaves it
 	return s;
 }
 
 
-//function used to initialize the page scan; open a scan on page found in searchtree in btreefile.cpp
-Status BTreeFileScan::_SetIter() {  
-    PIN(currentPageID, currentPage);
+//function used to initialize the page scan; pins pid, releasing the page before
+//it, and opens a scan on it. The page stays pinned until GetNext moves past it 
+//or the scan ends.
+Status BTreeFileScan::_SetIter(PageID pid) {  
+	PIN_GUARD(pageGuard, pid, currentPage);
+	return this->_OpenIter();
+}
+
+
+//function used to open the page scan on the current page, which is already
+//pinned by pageGuard, e.g. by the search in btreefile.cpp
+Status BTreeFileScan::_OpenIter() {
 	scan = new PageKVScan<RecordID>();
 	currentPage->OpenScan(scan);
-	UNPIN(currentPageID, CLEAN);
 	return OK;
-}
\ No newline at end of file
+}
+
+
+//function used to end the scan; releases the current page and its page scan
+Status BTreeFileScan::_EndScan() {
+	this->done = true;
+	delete scan;
+	scan = NULL;
+	if (pageGuard.Release() != OK) {
+		return FAIL;
+	}
+	return DONE;
+}
@@ -1,7 +1,11 @@
 #include "BTreeTest.h"
 #include "bufmgr.h"
+#include "KeyCompare.h"
 #include <ctime>
+#include <climits>
 #include <vector>
+#include <algorithm>
+#include <string>
 
 //-------------------------------------------------------------------
 // BTreeDriver::toString
@@ -220,7 +224,7 @@ bool BTreeDriver::InsertDuplicates(BTreeFile* btf, int key, int numDups,
 	}
 	return true;
 }
-/*
+
 bool BTreeDriver::DeleteStride(BTreeFile* btf, int low, int high,
 	                           int stride, int pad) {
 
@@ -278,7 +282,6 @@ bool BTreeDriver::DeleteStride(BTreeFile* btf, int low, int high,
 
 	return true;
 }
-*/
 
 
 //-------------------------------------------------------------------
@@ -291,10 +294,33 @@ bool BTreeDriver::DeleteStride(BTreeFile* btf, int low, int high,
 // Purpose : Tests the number of leaf pages in the tree. 
 //-------------------------------------------------------------------
 bool BTreeDriver::TestNumLeafPages(BTreeFile* btf, int expected) {
+	int numPages = CountLeafPages(btf);
+	if(numPages < 0) {
+		return false;
+	}
+
+	if(numPages != expected) {
+		std::cerr << "Unexpected number of leaf pages. Expected " << expected
+			      << " Got " << numPages << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+//-------------------------------------------------------------------
+// BTreeDriver::CountLeafPages
+//
+// Input   : btf,  The BTree to count. 
+// Output  : None
+// Return  : The number of leaf pages in the tree, or -1 on error.
+// Purpose : Walks the leaf chain and counts the pages on it. 
+//-------------------------------------------------------------------
+int BTreeDriver::CountLeafPages(BTreeFile* btf) {
 	PageID pid = btf->GetLeftLeaf();
 	if(pid == INVALID_PAGE) {
 		std::cerr << "Unable to access left leaf" << std::endl;
-		return false;
+		return -1;
 	}
 	int numPages = 0;
 
@@ -305,27 +331,194 @@ bool BTreeDriver::TestNumLeafPages(BTreeFile* btf, int expected) {
 		LeafPage* leaf;
 		if(MINIBASE_BM->PinPage(pid, (Page*&)leaf) == FAIL) {
 			std::cerr << "Unable to pin leaf page" << std::endl;
-			return false;
+			return -1;
 		}
 
 		pid = leaf->GetNextPage();
 
 		if(MINIBASE_BM->UnpinPage(leaf->PageNo(), CLEAN) == FAIL) {
 			std::cerr << "Unable to unpin leaf page" << std::endl;
-			return false;
+			return -1;
 		}
 
 	}
 
-	if(numPages != expected) {
-		std::cerr << "Unexpected number of leaf pages. Expected " << expected
-			      << " Got " << numPages << std::endl;
-		return false;
+	return numPages;
+}
+
+//-------------------------------------------------------------------
+// BTreeDriver::CountIntLeafPages
+//
+// Input   : ibtf,  The integer BTree to count. 
+// Output  : None
+// Return  : The number of leaf pages in the tree, or -1 on error or if
+//           a leaf does not link back to the one before it.
+// Purpose : Walks the leaf chain from the leftmost leaf. 
+//-------------------------------------------------------------------
+int BTreeDriver::CountIntLeafPages(IntBTreeFile* ibtf) {
+	PageGuard leafGuard;
+	IntLeafPage* leaf;
+	if(ibtf->FindLeaf(LLONG_MIN, true, leafGuard, leaf) != OK) {
+		std::cerr << "Unable to access left leaf" << std::endl;
+		return -1;
+	}
+	int numPages = 1;
+
+	while(leaf->GetNextPage() != INVALID_PAGE) {
+		PageID prevPid = leafGuard.PageNo();
+		if(leafGuard.Pin(leaf->GetNextPage(), leaf) != OK) {
+			std::cerr << "Unable to pin leaf page" << std::endl;
+			return -1;
+		}
+		if(leaf->GetPrevPage() != prevPid) {
+			std::cerr << "Leaf " << leafGuard.PageNo() << " does not link back to " << prevPid << std::endl;
+			return -1;
+		}
+		numPages++;
+	}
+
+	return numPages;
+}
+
+//-------------------------------------------------------------------
+// BTreeDriver::TestRightLinks
+//
+// Input   : btf,  The BTree to check. 
+// Output  : None
+// Return  : True if every level of the tree is linked left to right 
+//           through nextPage, false otherwise.
+// Purpose : Collects the pages of each level from their parents and 
+//           checks that each page links to the next one, and the last 
+//           page of the level to nothing. 
+//-------------------------------------------------------------------
+bool BTreeDriver::TestRightLinks(BTreeFile* btf) {
+	std::vector<PageID> level;
+	if(btf->header->GetRootPageID() != INVALID_PAGE) {
+		level.push_back(btf->header->GetRootPageID());
+	}
+
+	for(int depth = 0; !level.empty(); depth++) {
+		std::vector<PageID> below;
+		for(unsigned int i = 0; i < level.size(); i++) {
+			ResizableRecordPage* page;
+			if(MINIBASE_BM->PinPage(level[i], (Page*&)page) == FAIL) {
+				std::cerr << "Unable to pin page " << level[i] << std::endl;
+				return false;
+			}
+
+			PageID expected = (i + 1 < level.size()) ? level[i + 1] : INVALID_PAGE;
+			PageID next = page->GetNextPage();
+			if(page->GetType() == INDEX_PAGE) {
+				IndexPage* indexPage = (IndexPage*) page;
+				below.push_back(indexPage->GetPrevPage());
+
+				PageKVScan<PageID> scan;
+				char* key;
+				PageID child;
+				if(indexPage->OpenScan(&scan) == OK) {
+					while(scan.GetNext(key, child) == OK) {
+						below.push_back(child);
+					}
+				}
+			}
+
+			if(MINIBASE_BM->UnpinPage(level[i], CLEAN) == FAIL) {
+				std::cerr << "Unable to unpin page " << level[i] << std::endl;
+				return false;
+			}
+			if(next != expected) {
+				std::cerr << "Page " << level[i] << " at depth " << depth << " links to " 
+					      << next << ", expected " << expected << std::endl;
+				return false;
+			}
+		}
+		level = below;
+	}
+
+	return true;
+}
+
+//-------------------------------------------------------------------
+// BTreeDriver::TestIndexKeys
+//
+// Input   : btf,  The BTree to check. 
+// Output  : None
+// Return  : True if every index page except the root holds at least 
+//           one key, false otherwise.
+// Purpose : An index page without keys only has its leftmost child, 
+//           which the rest of the tree does not expect. 
+//-------------------------------------------------------------------
+bool BTreeDriver::TestIndexKeys(BTreeFile* btf) {
+	std::vector<PageID> pages;
+	PageID rootPid = btf->header->GetRootPageID();
+	if(rootPid != INVALID_PAGE) {
+		pages.push_back(rootPid);
 	}
 
+	while(!pages.empty()) {
+		PageID pid = pages.back();
+		pages.pop_back();
+
+		ResizableRecordPage* page;
+		if(MINIBASE_BM->PinPage(pid, (Page*&)page) == FAIL) {
+			std::cerr << "Unable to pin page " << pid << std::endl;
+			return false;
+		}
+
+		bool empty = false;
+		if(page->GetType() == INDEX_PAGE) {
+			IndexPage* indexPage = (IndexPage*) page;
+			pages.push_back(indexPage->GetPrevPage());
+
+			PageKVScan<PageID> scan;
+			char* key;
+			PageID child;
+			empty = true;
+			if(indexPage->OpenScan(&scan) == OK) {
+				while(scan.GetNext(key, child) == OK) {
+					pages.push_back(child);
+					empty = false;
+				}
+			}
+		}
+
+		if(MINIBASE_BM->UnpinPage(pid, CLEAN) == FAIL) {
+			std::cerr << "Unable to unpin page " << pid << std::endl;
+			return false;
+		}
+		if(empty && pid != rootPid) {
+			std::cerr << "Index page " << pid << " has no keys." << std::endl;
+			return false;
+		}
+	}
 	return true;
 }
 
+//-------------------------------------------------------------------
+// BTreeDriver::TreeHeight
+//
+// Input   : btf,  The BTree to measure. 
+// Output  : None
+// Return  : The number of levels in the tree, or -1 on error.
+// Purpose : Follows the leftmost children from the root down to a leaf. 
+//-------------------------------------------------------------------
+int BTreeDriver::TreeHeight(BTreeFile* btf) {
+	int height = 0;
+	PageID pid = btf->header->GetRootPageID();
+	while(pid != INVALID_PAGE) {
+		ResizableRecordPage* page;
+		if(MINIBASE_BM->PinPage(pid, (Page*&)page) == FAIL) {
+			std::cerr << "Unable to pin page " << pid << std::endl;
+			return -1;
+		}
+		height++;
+		PageID child = (page->GetType() == INDEX_PAGE) ? page->GetPrevPage() : INVALID_PAGE;
+		MINIBASE_BM->UnpinPage(pid, CLEAN);
+		pid = child;
+	}
+	return height;
+}
+
 //-------------------------------------------------------------------
 // BTreeDriver::TestNumLeafPages
 //
@@ -1088,4 +1281,1624 @@ bool BTreeDriver::TestPerformance() {
 	}
 
 	return res;
-}
\ No newline at end of file
+}
+
+//-------------------------------------------------------------------
+// BTreeDriver::TestKeyPair
+//
+// Input   : a, b,  The keys to compare.
+// Output  : None
+// Return  : True if KeyCompare orders a and b the same way as strcmp, 
+//           in both argument orders. 
+//-------------------------------------------------------------------
+bool BTreeDriver::TestKeyPair(const char* a, const char* b) {
+	int expected = strcmp(a, b);
+	int got = KeyCompare(a, b);
+	int reversed = KeyCompare(b, a);
+	if((expected < 0) != (got < 0) || (expected > 0) != (got > 0) ||
+	   (expected < 0) != (reversed > 0) || (expected > 0) != (reversed < 0)) {
+		std::cerr << "Error: KeyCompare disagrees with strcmp on '" << a << "' and '" 
+			      << b << "'" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+//-------------------------------------------------------------------
+// BTreeDriver::TestKeySearch
+//
+// Input   : key,      The key to search for.
+//           keys,     numKeys keys in ascending order.
+// Output  : None
+// Return  : True if KeySearch finds the same position as a linear 
+//           search with strcmp. 
+//-------------------------------------------------------------------
+bool BTreeDriver::TestKeySearch(const char* key, const char* const* keys, int numKeys) {
+	int expected = 0;
+	while(expected < numKeys && strcmp(keys[expected], key) < 0) {
+		expected++;
+	}
+	bool expectedFound = (expected < numKeys && strcmp(keys[expected], key) == 0);
+
+	bool found;
+	int got = KeySearch(key, keys, numKeys, found);
+	if(got != expected || found != expectedFound) {
+		std::cerr << "Error: KeySearch searched for '" << key << "' at " << got 
+			      << " instead of " << expected << std::endl;
+		return false;
+	}
+	return true;
+}
+
+//-------------------------------------------------------------------
+// BTreeDriver::ByteCompare
+//
+// Input   : a, b,  The keys to compare.
+// Output  : None
+// Return  : <0, 0 or >0, as strcmp.
+// Purpose : Compares one byte per step, as a baseline for the benchmark
+//           in TestKeyCompare. 
+//-------------------------------------------------------------------
+int BTreeDriver::ByteCompare(const char* a, const char* b) {
+	while(*a != '\0' && *a == *b) {
+		a++;
+		b++;
+	}
+	return (unsigned char) *a - (unsigned char) *b;
+}
+
+//-------------------------------------------------------------------
+// BTreeDriver::TestKeyCompare
+//
+// Input   : None
+// Output  : None
+// Return  : True if KeyCompare and KeySearch agree with strcmp. 
+// Purpose : Checks KeyCompare and KeySearch on keys of mixed lengths,
+//           then times KeyCompare against a byte-at-a-time compare on 
+//           zero padded keys that share long prefixes. This is why 
+//           KeyCompare is plain strcmp: it already compares many bytes
+//           per step, and SSE2/AVX2 kernels did no better. 
+//-------------------------------------------------------------------
+bool BTreeDriver::TestKeyCompare() {
+	const int numKeys = 1000;
+	const int numCompares = 2000000;
+	bool res = true;
+
+	std::cout << "Starting Key Compare Test..." << std::endl;
+
+	// Keys of every length up to 70 over a two letter alphabet, so that 
+	// many pairs share a prefix or are a prefix of each other. 
+	std::vector<std::string> mixed;
+	mixed.push_back("");
+	srand(7);
+	for(int i = 0; i < 400; i++) {
+		std::string key(rand() % 70 + 1, 'a');
+		for(size_t j = 0; j < key.size(); j++) {
+			key[j] = (rand() % 2) ? 'a' : 'b';
+		}
+		mixed.push_back(key);
+		mixed.push_back(key.substr(0, rand() % key.size()));
+	}
+	std::sort(mixed.begin(), mixed.end());
+
+	for(size_t i = 0; i < mixed.size(); i++) {
+		res = TestKeyPair(mixed[i].c_str(), mixed[(i * 7919) % mixed.size()].c_str()) && res;
+		res = TestKeyPair(mixed[i].c_str(), mixed[(i + 1) % mixed.size()].c_str()) && res;
+	}
+
+	// Search runs of up to KEY_SEARCH_WINDOW keys, as FindKey does. 
+	for(size_t i = 0; i + KEY_SEARCH_WINDOW <= mixed.size(); i += 3) {
+		const char* keys[KEY_SEARCH_WINDOW];
+		int numRun = i % KEY_SEARCH_WINDOW + 1;
+		for(int j = 0; j < numRun; j++) {
+			keys[j] = mixed[i + j].c_str();
+		}
+		for(size_t j = (i > 2 ? i - 2 : 0); j < i + numRun + 2 && j < mixed.size(); j++) {
+			res = TestKeySearch(mixed[j].c_str(), keys, numRun) && res;
+		}
+	}
+
+	for(int pad = 20; pad <= 60; pad += 20) {
+		std::vector<std::string> keys;
+		char key[MAX_KEY_LENGTH];
+		for(int i = 0; i < numKeys; i++) {
+			toString((i * 7919) % numKeys, key, pad);
+			keys.push_back(key);
+		}
+
+		long sum = 0;
+		clock_t initTime = clock();
+		for(int i = 0; i < numCompares; i++) {
+			sum += KeyCompare(keys[i % numKeys].c_str(), keys[(i + 1) % numKeys].c_str()) < 0;
+		}
+		double keyCompareTime = (clock() - initTime) * (1000.0 / CLOCKS_PER_SEC);
+
+		initTime = clock();
+		for(int i = 0; i < numCompares; i++) {
+			sum -= ByteCompare(keys[i % numKeys].c_str(), keys[(i + 1) % numKeys].c_str()) < 0;
+		}
+		double byteTime = (clock() - initTime) * (1000.0 / CLOCKS_PER_SEC);
+
+		std::cout << "Comparing keys of length " << pad << " takes: " << keyCompareTime 
+			      << "ms with KeyCompare, " << byteTime << "ms a byte at a time"
+				  << " (" << (sum == 0) << ")" << std::endl;
+	}
+
+	return res;
+}
+
+
+bool BTreeDriver::TestPrefixCompression() {
+	Status status;
+	BTreeFile *plain;
+	BTreeFile *compressed;
+	bool res;
+
+	plain = new BTreeFile(status, "BTreeTest8a");
+	if (status != OK) {
+		minibase_errors.show_errors();
+		exit(1);
+	}
+	compressed = new BTreeFile(status, "BTreeTest8b", true);
+	if (status != OK) {
+		minibase_errors.show_errors();
+		exit(1);
+	}
+	std::cout << "Starting Prefix Compression Test..." << std::endl;
+
+	std::cout << "Inserting 2000 keys padded to 30 digits..." << std::endl;
+	res = InsertRange(plain, 1, 2000, 1, 30, true);
+	res = res && InsertRange(compressed, 1, 2000, 1, 30, true);
+	res = res && TestNumEntries(plain, 2000);
+	res = res && TestNumEntries(compressed, 2000);
+
+	int plainLeaves = CountLeafPages(plain);
+	int compressedLeaves = CountLeafPages(compressed);
+	std::cout << "Leaf pages: plain " << plainLeaves 
+		      << " compressed " << compressedLeaves << std::endl;
+	if(compressedLeaves <= 0 || compressedLeaves >= plainLeaves) {
+		std::cerr << "Error: Expected fewer leaf pages with prefix compression." << std::endl;
+		res = false;
+	}
+
+	std::cout << "RES 1: " << res << std::endl;
+
+	std::cout << "Checking a few individual keys..." << std::endl;
+	res = res && TestAbsent(compressed, 0, 1, 30);
+	res = res && TestPresent(compressed, 1, 1, 30);
+	res = res && TestPresent(compressed, 1234, 1, 30);
+	res = res && TestPresent(compressed, 2000, 1, 30);
+	res = res && TestAbsent(compressed, 2001, 1, 30);
+
+	std::cout << "Inserting keys that shorten the page prefixes..." << std::endl;
+	res = res && InsertRange(compressed, 1, 2000, 2, 3);
+	res = res && InsertDuplicates(compressed, 7, 100, 1, 30);
+	res = res && TestNumEntries(compressed, 4100);
+
+	char low[MAX_KEY_LENGTH];
+	char high[MAX_KEY_LENGTH];
+	toString(500, low, 30);
+	toString(1499, high, 30);
+	BTreeFileScan* scan = compressed->OpenScan(low, high);
+	res = res && TestScanCount(scan, 1000);
+	delete scan;
+
+	std::cout << "RES 2: " << res << std::endl;
+
+	if(plain->DestroyFile() != OK || compressed->DestroyFile() != OK) {
+		std::cerr << "Error destroying BTreeFile" << std::endl;
+		res = false;
+	}
+
+	delete plain;
+	delete compressed;
+	return res;
+}
+
+
+bool BTreeDriver::TestSeparatorTruncation() {
+	Status status;
+	BTreeFile *btf;
+	bool res = true;
+
+	btf = new BTreeFile(status, "BTreeTest9");
+	if (status != OK) {
+		minibase_errors.show_errors();
+		exit(1);
+	}
+	std::cout << "Starting Separator Truncation Test..." << std::endl;
+
+	// Keys differ in their first five characters and share a long suffix,
+	// so a five character separator is enough between any two leaves.
+	const char* suffix = "-separator-truncation-test-suffix";
+	char skey[MAX_KEY_LENGTH];
+	int fullLength = 0;
+
+	std::cout << "Inserting 1000 keys with a long common suffix..." << std::endl;
+	for(int i = 1; i <= 1000 && res; i++) {
+		RecordID rid;
+		rid.pageNo = i;
+		rid.slotNo = i + 1;
+		toString(i, skey, 5);
+		strcat(skey, suffix);
+		fullLength = strlen(skey);
+
+		if (btf->Insert(skey, rid) != OK) {
+			std::cerr << "Insertion failed at key=" << skey << std::endl;
+			res = false;
+		}
+	}
+	res = res && TestNumEntries(btf, 1000);
+
+	std::cout << "RES 1: " << res << std::endl;
+
+	std::cout << "Checking separator lengths on the root page..." << std::endl;
+	IndexPage* root;
+	PageID rootPid = btf->header->GetRootPageID();
+	if(MINIBASE_BM->PinPage(rootPid, (Page*&)root) == FAIL) {
+		std::cerr << "Unable to pin root page" << std::endl;
+		return false;
+	}
+	if(root->GetType() != INDEX_PAGE) {
+		std::cerr << "Error: Expected the root to be an index page." << std::endl;
+		res = false;
+	}
+	else {
+		PageKVScan<PageID> iter;
+		root->OpenScan(&iter);
+		char* key;
+		PageID pid;
+		while(iter.GetNext(key, pid) == OK) {
+			if((int) strlen(key) >= fullLength) {
+				std::cerr << "Error: Separator " << key << " was not truncated." << std::endl;
+				res = false;
+			}
+		}
+	}
+	if(MINIBASE_BM->UnpinPage(rootPid, CLEAN) == FAIL) {
+		std::cerr << "Unable to unpin root page" << std::endl;
+		res = false;
+	}
+
+	std::cout << "RES 2: " << res << std::endl;
+
+	std::cout << "Checking scans across the separators..." << std::endl;
+	char low[MAX_KEY_LENGTH];
+	char high[MAX_KEY_LENGTH];
+	toString(250, low, 5);
+	toString(750, high, 5);
+	strcat(low, suffix);
+	strcat(high, suffix);
+	BTreeFileScan* scan = btf->OpenScan(low, high);
+	res = res && TestScanCount(scan, 501);
+	delete scan;
+
+	toString(250, low, 5);
+	toString(251, high, 5);
+	scan = btf->OpenScan(low, high);
+	res = res && TestScanCount(scan, 1);
+	delete scan;
+
+	std::cout << "RES 3: " << res << std::endl;
+
+	if(btf->DestroyFile() != OK) {
+		std::cerr << "Error destroying BTreeFile" << std::endl;
+		res = false;
+	}
+
+	delete btf;
+	return res;
+}
+
+
+// Feeds BulkLoad from keys held in memory. 
+class VectorBulkLoadSource : public BulkLoadSource {
+public:
+	std::vector<std::string> keys;
+	std::vector<RecordID> rids;
+	unsigned int next;
+	unsigned int failAt;
+
+	VectorBulkLoadSource() : next(0), failAt(0) {}
+
+	void Add(const char* key, int ridNum) {
+		RecordID rid;
+		rid.pageNo = ridNum;
+		rid.slotNo = ridNum + 1;
+		keys.push_back(key);
+		rids.push_back(rid);
+	}
+
+	Status GetNext(const char*& key, RecordID& rid) {
+		// Simulates a failing stream once failAt pairs were returned.
+		if(failAt > 0 && next >= failAt) {
+			return FAIL;
+		}
+		if(next >= keys.size()) {
+			return DONE;
+		}
+		key = keys[next].c_str();
+		rid = rids[next];
+		next++;
+		return OK;
+	}
+};
+
+
+// Feeds IntBTreeFile::BulkLoad from keys held in memory.
+class VectorIntBulkLoadSource : public IntBulkLoadSource {
+public:
+	std::vector<IntKey> keys;
+	std::vector<RecordID> rids;
+	unsigned int next;
+
+	VectorIntBulkLoadSource() : next(0) {}
+
+	void Add(IntKey key, int ridNum) {
+		RecordID rid;
+		rid.pageNo = ridNum;
+		rid.slotNo = ridNum + 1;
+		keys.push_back(key);
+		rids.push_back(rid);
+	}
+
+	Status GetNext(IntKey& key, RecordID& rid) {
+		if(next >= keys.size()) {
+			return DONE;
+		}
+		key = keys[next];
+		rid = rids[next];
+		next++;
+		return OK;
+	}
+};
+
+
+bool BTreeDriver::TestBulkLoad() {
+	Status status;
+	BTreeFile *full;
+	BTreeFile *sparse;
+	BTreeFile *inserted;
+	bool res = true;
+	clock_t initTime;
+	double timeInMilliseconds;
+
+	std::cout << "Starting Bulk Load Test..." << std::endl;
+
+	// keys 1..5000, where every key divisible by 100 gets 20 values
+	char skey[MAX_KEY_LENGTH];
+	VectorBulkLoadSource fullSource;
+	VectorBulkLoadSource sparseSource;
+	int numEntries = 0;
+	for(int i = 1; i <= 5000; i++) {
+		toString(i, skey, 5);
+		int numValues = (i % 100 == 0) ? 20 : 1;
+		for(int j = 1; j <= numValues; j++) {
+			fullSource.Add(skey, i + j);
+			sparseSource.Add(skey, i + j);
+			numEntries++;
+		}
+	}
+
+	full = new BTreeFile(status, "BTreeTest10a");
+	sparse = new BTreeFile(status, "BTreeTest10b");
+	inserted = new BTreeFile(status, "BTreeTest10c");
+	if (status != OK) {
+		minibase_errors.show_errors();
+		exit(1);
+	}
+
+	initTime = clock();
+	if(full->BulkLoad(fullSource) != OK) {
+		std::cerr << "Error: BulkLoad failed." << std::endl;
+		res = false;
+	}
+	timeInMilliseconds = (clock() - initTime) * 1000.0 / CLOCKS_PER_SEC;
+	std::cout << "Bulk loading " << numEntries << " takes: " << timeInMilliseconds << "ms" << std::endl;
+
+	initTime = clock();
+	for(unsigned int i = 0; i < fullSource.keys.size() && res; i++) {
+		if(inserted->Insert(fullSource.keys[i].c_str(), fullSource.rids[i]) != OK) {
+			std::cerr << "Error: Insert failed." << std::endl;
+			res = false;
+		}
+	}
+	timeInMilliseconds = (clock() - initTime) * 1000.0 / CLOCKS_PER_SEC;
+	std::cout << "Inserting " << numEntries << " takes: " << timeInMilliseconds << "ms" << std::endl;
+
+	res = res && (sparse->BulkLoad(sparseSource, 0.5) == OK);
+	res = res && TestNumEntries(full, numEntries);
+	res = res && TestNumEntries(sparse, numEntries);
+
+	int fullLeaves = CountLeafPages(full);
+	int sparseLeaves = CountLeafPages(sparse);
+	int insertedLeaves = CountLeafPages(inserted);
+	std::cout << "Leaf pages: bulk loaded " << fullLeaves << " at 50% " << sparseLeaves
+		      << " inserted " << insertedLeaves << std::endl;
+	if(fullLeaves > insertedLeaves || sparseLeaves <= fullLeaves) {
+		std::cerr << "Error: Unexpected number of leaf pages." << std::endl;
+		res = false;
+	}
+
+	std::cout << "RES 1: " << res << std::endl;
+
+	std::cout << "Checking keys and scans..." << std::endl;
+	res = res && TestAbsent(full, 0, 1, 5);
+	res = res && TestPresent(full, 1, 1, 5);
+	res = res && TestPresent(full, 2500, 1, 5);
+	res = res && TestPresent(full, 5000, 1, 5);
+	res = res && TestAbsent(full, 5001, 1, 5);
+
+	char low[MAX_KEY_LENGTH];
+	char high[MAX_KEY_LENGTH];
+	toString(1000, low, 5);
+	toString(1000, high, 5);
+	BTreeFileScan* scan = full->OpenScan(low, high);
+	res = res && TestScanCount(scan, 20);
+	delete scan;
+
+	toString(950, low, 5);
+	toString(1050, high, 5);
+	scan = sparse->OpenScan(low, high);
+	res = res && TestScanCount(scan, 101 + 19);
+	delete scan;
+
+	std::cout << "RES 2: " << res << std::endl;
+
+	std::cout << "Inserting into the loaded trees..." << std::endl;
+	res = res && InsertRange(full, 5001, 6000, 1, 5);
+	res = res && InsertRange(sparse, 1, 5000, 2, 5);
+	res = res && TestNumEntries(full, numEntries + 1000);
+	res = res && TestNumEntries(sparse, numEntries + 5000);
+	res = res && TestPresent(sparse, 1234, 2, 5);
+
+	std::cout << "RES 3: " << res << std::endl;
+
+	std::cout << "Checking that unsorted input is rejected..." << std::endl;
+	VectorBulkLoadSource unsorted;
+	unsorted.Add("b", 1);
+	unsorted.Add("a", 2);
+	BTreeFile *bad = new BTreeFile(status, "BTreeTest10d");
+	if(bad->BulkLoad(unsorted) != FAIL) {
+		std::cerr << "Error: BulkLoad accepted unsorted input." << std::endl;
+		res = false;
+	}
+	if(full->BulkLoad(fullSource) != FAIL) {
+		std::cerr << "Error: BulkLoad accepted a non-empty index." << std::endl;
+		res = false;
+	}
+
+	std::cout << "RES 4: " << res << std::endl;
+
+	std::cout << "Checking that a failed load releases its pages..." << std::endl;
+	unsigned int unpinned = MINIBASE_BM->GetNumOfUnpinnedBuffers();
+	fullSource.next = 0;
+	fullSource.failAt = numEntries - 100;
+	if(bad->BulkLoad(fullSource) != FAIL) {
+		std::cerr << "Error: BulkLoad ignored a failing source." << std::endl;
+		res = false;
+	}
+	if(MINIBASE_BM->GetNumOfUnpinnedBuffers() != unpinned) {
+		std::cerr << "Error: Failed BulkLoad left pages pinned." << std::endl;
+		res = false;
+	}
+	if(bad->header->GetRootPageID() != INVALID_PAGE) {
+		std::cerr << "Error: Failed BulkLoad left a root behind." << std::endl;
+		res = false;
+	}
+	fullSource.next = 0;
+	fullSource.failAt = 0;
+	res = res && (bad->BulkLoad(fullSource) == OK);
+	res = res && TestNumEntries(bad, numEntries);
+
+	std::cout << "RES 5: " << res << std::endl;
+
+	std::cout << "Checking that index pages below the root have keys..." << std::endl;
+	res = res && TestIndexKeys(full) && TestIndexKeys(sparse) && TestIndexKeys(bad);
+
+	// free the trees above first, so each load below has the DB to itself
+	if(full->DestroyFile() != OK || sparse->DestroyFile() != OK ||
+	   inserted->DestroyFile() != OK || bad->DestroyFile() != OK) {
+		std::cerr << "Error destroying BTreeFile" << std::endl;
+		res = false;
+	}
+	delete full;
+	delete sparse;
+	delete inserted;
+	delete bad;
+
+	// Every length up to three levels, so that some loads end right after
+	// a new index page was started. The longest load takes about 530 of
+	// the 1000 pages in the DB.
+	for(int length = 100; length <= 12000 && res; length += 997) {
+		VectorBulkLoadSource source;
+		for(int i = 1; i <= length; i++) {
+			toString(i, skey, 20);
+			source.Add(skey, i);
+		}
+		BTreeFile *sized = new BTreeFile(status, "BTreeTest10e");
+		res = (status == OK) && (sized->BulkLoad(source, 0.7) == OK);
+		res = res && TestNumEntries(sized, length) && TestIndexKeys(sized) && TestRightLinks(sized);
+		if(sized->DestroyFile() != OK) {
+			res = false;
+		}
+		delete sized;
+	}
+
+	std::cout << "RES 6: " << res << std::endl;
+	return res;
+}
+
+
+bool BTreeDriver::TestInsertBatch() {
+	Status status;
+	BTreeFile *batched;
+	BTreeFile *single;
+	bool res = true;
+	clock_t initTime;
+	double timeInMilliseconds;
+
+	batched = new BTreeFile(status, "BTreeTest11a");
+	single = new BTreeFile(status, "BTreeTest11b");
+	if (status != OK) {
+		minibase_errors.show_errors();
+		exit(1);
+	}
+	std::cout << "Starting Insert Batch Test..." << std::endl;
+
+	// keys 1..6000 in a scrambled order, each with the rid InsertRange would use
+	const int numKeys = 6000;
+	const int batchSize = 1000;
+	std::vector<std::string> keys;
+	std::vector<RecordID> rids;
+	char skey[MAX_KEY_LENGTH];
+	for(int i = 0; i < numKeys; i++) {
+		int keyNum = (i * 7919) % numKeys + 1;
+		RecordID rid;
+		rid.pageNo = keyNum + 1;
+		rid.slotNo = keyNum + 2;
+		toString(keyNum, skey, 5);
+		keys.push_back(skey);
+		rids.push_back(rid);
+	}
+	std::vector<const char*> keyPtrs;
+	for(int i = 0; i < numKeys; i++) {
+		keyPtrs.push_back(keys[i].c_str());
+	}
+
+	long batchPins, singlePins, misses;
+
+	std::cout << "Inserting " << numKeys << " keys in batches of " << batchSize << "..." << std::endl;
+	MINIBASE_BM->ResetStat();
+	initTime = clock();
+	for(int i = 0; i < numKeys && res; i += batchSize) {
+		if(batched->InsertBatch(&keyPtrs[i], &rids[i], batchSize) != OK) {
+			std::cerr << "Error: InsertBatch failed." << std::endl;
+			res = false;
+		}
+	}
+	timeInMilliseconds = (clock() - initTime) * 1000.0 / CLOCKS_PER_SEC;
+	MINIBASE_BM->GetStat(batchPins, misses);
+	std::cout << "Batch inserting " << numKeys << " takes: " << timeInMilliseconds << "ms, "
+		      << batchPins << " pins" << std::endl;
+
+	MINIBASE_BM->ResetStat();
+	initTime = clock();
+	for(int i = 0; i < numKeys && res; i++) {
+		if(single->Insert(keyPtrs[i], rids[i]) != OK) {
+			std::cerr << "Error: Insert failed." << std::endl;
+			res = false;
+		}
+	}
+	timeInMilliseconds = (clock() - initTime) * 1000.0 / CLOCKS_PER_SEC;
+	MINIBASE_BM->GetStat(singlePins, misses);
+	std::cout << "Inserting " << numKeys << " takes: " << timeInMilliseconds << "ms, "
+		      << singlePins << " pins" << std::endl;
+
+	if(batchPins >= singlePins) {
+		std::cerr << "Error: Expected batched inserts to pin fewer pages." << std::endl;
+		res = false;
+	}
+
+	res = res && TestNumEntries(batched, numKeys);
+	res = res && TestAbsent(batched, 0, 1, 5);
+	res = res && TestPresent(batched, 1, 1, 5);
+	res = res && TestPresent(batched, 4321, 1, 5);
+	res = res && TestPresent(batched, 6000, 1, 5);
+	res = res && TestAbsent(batched, 6001, 1, 5);
+
+	std::cout << "RES 1: " << res << std::endl;
+
+	std::cout << "Inserting a batch of duplicates..." << std::endl;
+	std::vector<const char*> dupKeys;
+	std::vector<RecordID> dupRids;
+	toString(3000, skey, 5);
+	for(int i = 0; i < 150; i++) {
+		RecordID rid;
+		rid.pageNo = i;
+		rid.slotNo = i;
+		dupKeys.push_back(skey);
+		dupRids.push_back(rid);
+	}
+	res = res && (batched->InsertBatch(&dupKeys[0], &dupRids[0], 150) == OK);
+	res = res && TestNumEntries(batched, numKeys + 150);
+
+	char low[MAX_KEY_LENGTH];
+	char high[MAX_KEY_LENGTH];
+	toString(3000, low, 5);
+	toString(3000, high, 5);
+	BTreeFileScan* scan = batched->OpenScan(low, high);
+	res = res && TestScanCount(scan, 151);
+	delete scan;
+
+	toString(1000, low, 5);
+	toString(1999, high, 5);
+	scan = batched->OpenScan(low, high);
+	res = res && TestScanCount(scan, 1000);
+	delete scan;
+
+	std::cout << "RES 2: " << res << std::endl;
+
+	std::cout << "Inserting batches with a full buffer pool..." << std::endl;
+	BTreeFile *starved = new BTreeFile(status, "BTreeTest11c");
+	res = res && (status == OK) && InsertRange(starved, numKeys + 1, numKeys + 2000, 1, 5);
+	int height = TreeHeight(starved);
+	unsigned int unpinned = MINIBASE_BM->GetNumOfUnpinnedBuffers();
+
+	// leave enough frames for one path down the tree, but not for splits
+	std::vector<PageID> fillers;
+	while(MINIBASE_BM->GetNumOfUnpinnedBuffers() > (unsigned int) height) {
+		PageID pid;
+		Page* page;
+		if(MINIBASE_BM->NewPage(pid, page) != OK) {
+			break;
+		}
+		fillers.push_back(pid);
+	}
+
+	int numFailed = 0;
+	for(int i = 0; i < numKeys; i += batchSize / 5) {
+		if(starved->InsertBatch(&keyPtrs[i], &rids[i], batchSize / 5) != OK) {
+			numFailed++;
+		}
+	}
+	std::cout << numFailed << " batches failed" << std::endl;
+	if(numFailed == 0) {
+		std::cerr << "Error: Expected batches to fail with a full pool." << std::endl;
+		res = false;
+	}
+
+	for(unsigned int i = 0; i < fillers.size(); i++) {
+		MINIBASE_BM->UnpinPage(fillers[i], CLEAN);
+		MINIBASE_BM->FreePage(fillers[i]);
+	}
+	if(MINIBASE_BM->GetNumOfUnpinnedBuffers() != unpinned) {
+		std::cerr << "Error: " << unpinned - MINIBASE_BM->GetNumOfUnpinnedBuffers() 
+			      << " pages were left pinned." << std::endl;
+		res = false;
+	}
+
+	// Every entry a scan finds has to be found from the root as well, or 
+	// a page split by a failed batch was not added to its parent.
+	scan = starved->OpenScan(NULL, NULL);
+	char* scanKey;
+	RecordID scanRid;
+	int numScanned = 0;
+	while(scan->GetNext(scanRid, scanKey) == OK) {
+		RecordID found[2];
+		int numFound;
+		numScanned++;
+		if(starved->Lookup(scanKey, found, 2, numFound) != OK || numFound == 0) {
+			std::cerr << "Error: " << scanKey << " is only reachable by a scan." << std::endl;
+			res = false;
+			break;
+		}
+	}
+	delete scan;
+	std::cout << numScanned - 2000 << " of " << numKeys << " keys went in" << std::endl;
+
+	// the rest go in once there is room again
+	for(int i = 0; i < numKeys && res; i++) {
+		RecordID found[2];
+		int numFound;
+		if(starved->Lookup(keyPtrs[i], found, 2, numFound) != OK) {
+			res = (starved->Insert(keyPtrs[i], rids[i]) == OK);
+		}
+	}
+	res = res && TestNumEntries(starved, 2000 + numKeys);
+	res = res && TestRightLinks(starved);
+
+	std::cout << "RES 3: " << res << std::endl;
+
+	if(starved->DestroyFile() != OK) {
+		res = false;
+	}
+	delete starved;
+
+	if(batched->DestroyFile() != OK || single->DestroyFile() != OK) {
+		std::cerr << "Error destroying BTreeFile" << std::endl;
+		res = false;
+	}
+
+	delete batched;
+	delete single;
+	return res;
+}
+
+
+bool BTreeDriver::TestLookup() {
+	Status status;
+	BTreeFile *btf;
+	bool res;
+	clock_t initTime;
+	double timeInMilliseconds;
+	long lookupPins, scanPins, misses;
+
+	btf = new BTreeFile(status, "BTreeTest12");
+	if (status != OK) {
+		minibase_errors.show_errors();
+		exit(1);
+	}
+	std::cout << "Starting Lookup Test..." << std::endl;
+
+	// key 2500 gets enough values to span several leaves
+	res = InsertRange(btf, 1, 5000, 1, 5);
+	res = res && InsertDuplicates(btf, 2500, 400, 1, 5);
+	res = res && TestNumEntries(btf, 5400);
+
+	char skey[MAX_KEY_LENGTH];
+	RecordID rids[500];
+	int numRids;
+
+	std::cout << "Looking up single keys..." << std::endl;
+	toString(1234, skey, 5);
+	if(btf->Lookup(skey, rids, 500, numRids) != OK || numRids != 1 ||
+	   rids[0].pageNo != 1235 || rids[0].slotNo != 1236) {
+		std::cerr << "Error: Lookup of " << skey << " failed." << std::endl;
+		res = false;
+	}
+	toString(5001, skey, 5);
+	if(btf->Lookup(skey, rids, 500, numRids) != DONE || numRids != 0) {
+		std::cerr << "Error: Lookup found absent key " << skey << std::endl;
+		res = false;
+	}
+
+	std::cout << "RES 1: " << res << std::endl;
+
+	std::cout << "Looking up a key with many values..." << std::endl;
+	toString(2500, skey, 5);
+	if(btf->Lookup(skey, rids, 500, numRids) != OK || numRids != 401) {
+		std::cerr << "Error: Expected 401 values for " << skey << " got " << numRids << std::endl;
+		res = false;
+	}
+
+	// a short buffer still reports how many values there are
+	if(btf->Lookup(skey, rids, 10, numRids) != OK || numRids != 401) {
+		std::cerr << "Error: Expected a count of 401 with a short buffer, got " << numRids << std::endl;
+		res = false;
+	}
+
+	std::cout << "RES 2: " << res << std::endl;
+
+	std::cout << "Comparing with exact match scans..." << std::endl;
+	MINIBASE_BM->ResetStat();
+	initTime = clock();
+	for(int i = 1; i <= 5000 && res; i++) {
+		toString(i, skey, 5);
+		if(btf->Lookup(skey, rids, 500, numRids) != OK) {
+			std::cerr << "Error: Lookup of " << skey << " failed." << std::endl;
+			res = false;
+		}
+	}
+	timeInMilliseconds = (clock() - initTime) * 1000.0 / CLOCKS_PER_SEC;
+	MINIBASE_BM->GetStat(lookupPins, misses);
+	std::cout << "5000 lookups take: " << timeInMilliseconds << "ms, " << lookupPins << " pins" << std::endl;
+
+	MINIBASE_BM->ResetStat();
+	initTime = clock();
+	for(int i = 1; i <= 5000 && res; i++) {
+		toString(i, skey, 5);
+		BTreeFileScan* scan = btf->OpenScan(skey, skey);
+		RecordID rid;
+		char* keyPtr;
+		while(scan->GetNext(rid, keyPtr) == OK);
+		delete scan;
+	}
+	timeInMilliseconds = (clock() - initTime) * 1000.0 / CLOCKS_PER_SEC;
+	MINIBASE_BM->GetStat(scanPins, misses);
+	std::cout << "5000 exact match scans take: " << timeInMilliseconds << "ms, " << scanPins << " pins" << std::endl;
+
+	if(lookupPins >= scanPins) {
+		std::cerr << "Error: Expected lookups to pin fewer pages than scans." << std::endl;
+		res = false;
+	}
+
+	std::cout << "RES 3: " << res << std::endl;
+
+	if(btf->DestroyFile() != OK) {
+		std::cerr << "Error destroying BTreeFile" << std::endl;
+		res = false;
+	}
+
+	delete btf;
+	return res;
+}
+
+
+bool BTreeDriver::TestDelete() {
+	Status status;
+	BTreeFile *btf;
+	bool res;
+
+	btf = new BTreeFile(status, "BTreeTest13");
+	if (status != OK) {
+		minibase_errors.show_errors();
+		exit(1);
+	}
+	std::cout << "Starting Delete Test..." << std::endl;
+
+	std::cout << "Inserting 3000 keys..." << std::endl;
+	res = InsertRange(btf, 1, 3000, 1, 5);
+	res = res && InsertDuplicates(btf, 1500, 300, 1, 5);
+	res = res && TestNumEntries(btf, 3300);
+	int fullLeaves = CountLeafPages(btf);
+
+	std::cout << "Deleting every other entry..." << std::endl;
+	res = res && DeleteStride(btf, 1, 3000, 2, 5);
+	res = res && TestNumEntries(btf, 1650);
+	res = res && TestPresent(btf, 2, 1, 5);
+	res = res && TestAbsent(btf, 3, 1, 5);
+	res = res && TestPresent(btf, 3000, 1, 5);
+
+	int halfLeaves = CountLeafPages(btf);
+	std::cout << "Leaf pages: full " << fullLeaves << " after deletes " << halfLeaves << std::endl;
+	if(halfLeaves >= fullLeaves) {
+		std::cerr << "Error: Expected deletes to merge leaf pages." << std::endl;
+		res = false;
+	}
+
+	std::cout << "RES 1: " << res << std::endl;
+
+	std::cout << "Deleting an entry that is not there..." << std::endl;
+	char skey[MAX_KEY_LENGTH];
+	RecordID rid;
+	rid.pageNo = 4;
+	rid.slotNo = 5;
+	toString(3, skey, 5);
+	if(btf->Delete(skey, rid) != FAIL) {
+		std::cerr << "Error: Deleted an absent entry." << std::endl;
+		res = false;
+	}
+
+	std::cout << "Deleting everything else..." << std::endl;
+	res = res && DeleteStride(btf, 1, 3000, 1, 5);
+	res = res && TestNumEntries(btf, 0);
+	res = res && TestNumLeafPages(btf, 1);
+
+	std::cout << "RES 2: " << res << std::endl;
+
+	std::cout << "Inserting again..." << std::endl;
+	res = res && InsertRange(btf, 1, 1000, 1, 5, true);
+	res = res && TestNumEntries(btf, 1000);
+	res = res && TestPresent(btf, 500, 1, 5);
+
+	std::cout << "RES 3: " << res << std::endl;
+
+	// the values of a key spread over several leaves move between them
+	// as the leaves are rebalanced, and must keep the order they were 
+	// inserted in
+	std::cout << "Deleting duplicates on several leaves..." << std::endl;
+	const int numDups = 1200;
+	res = res && InsertDuplicates(btf, 2000, numDups, 1, 5);
+	res = res && DeleteStride(btf, 2000, 2000, 3, 5);
+
+	RecordID dups[numDups];
+	int numFound = 0;
+	toString(2000, skey, 5);
+	if(btf->Lookup(skey, dups, numDups, numFound) != OK || numFound != numDups - numDups / 3) {
+		std::cerr << "Error: Found " << numFound << " duplicates after deleting." << std::endl;
+		res = false;
+	}
+	for(int i = 1; i < numFound && res; i++) {
+		if(dups[i].pageNo <= dups[i - 1].pageNo) {
+			std::cerr << "Error: Duplicate " << dups[i] << " follows " << dups[i - 1] << std::endl;
+			res = false;
+		}
+	}
+
+	std::cout << "RES 4: " << res << std::endl;
+
+	if(btf->DestroyFile() != OK) {
+		std::cerr << "Error destroying BTreeFile" << std::endl;
+		res = false;
+	}
+
+	delete btf;
+	return res;
+}
+
+
+//-------------------------------------------------------------------
+// BTreeDriver::TestIntKeys
+//
+// Input   : None
+// Output  : None
+// Return  : True if IntBTreeFile finds, scans and deletes what was 
+//           inserted into it. 
+// Purpose : Checks the integer key tree, including keys that need all
+//           64 bits and a key with values on several leaves, and times 
+//           it against a BTreeFile holding the same keys as strings. 
+//           Also checks the page layout, the key type in the header, 
+//           how often a scan pins pages, that deletes merge leaves, and
+//           BulkLoad and InsertBatch.
+//-------------------------------------------------------------------
+bool BTreeDriver::TestIntKeys() {
+	Status status;
+	IntBTreeFile *ibtf;
+	BTreeFile *btf;
+	bool res = true;
+	clock_t initTime;
+	double intMilliseconds, stringMilliseconds;
+
+	const int numKeys = 5000;
+	const IntKey step = 4294967311LL; // keys do not fit in 32 bits
+
+	ibtf = new IntBTreeFile(status, "BTreeTest14");
+	if (status != OK) {
+		minibase_errors.show_errors();
+		exit(1);
+	}
+	btf = new BTreeFile(status, "BTreeTest14s");
+	if (status != OK) {
+		minibase_errors.show_errors();
+		exit(1);
+	}
+	std::cout << "Starting Integer Key Test..." << std::endl;
+
+	// insert in a scattered order, which splits pages all over the tree
+	std::cout << "Inserting " << numKeys << " keys..." << std::endl;
+	RecordID rid;
+	initTime = clock();
+	for(int i = 0; i < numKeys && res; i++) {
+		int n = (int) ((i * 7919LL) % numKeys);
+		rid.pageNo = n;
+		rid.slotNo = n + 1;
+		if(ibtf->Insert(n * step, rid) != OK) {
+			std::cerr << "Error: Failed to insert " << n * step << std::endl;
+			res = false;
+		}
+	}
+	intMilliseconds = (clock() - initTime) * 1000.0 / CLOCKS_PER_SEC;
+
+	char skey[MAX_KEY_LENGTH];
+	initTime = clock();
+	for(int i = 0; i < numKeys && res; i++) {
+		int n = (int) ((i * 7919LL) % numKeys);
+		rid.pageNo = n;
+		rid.slotNo = n + 1;
+		sprintf(skey, "%020lld", n * step);
+		res = (btf->Insert(skey, rid) == OK);
+	}
+	stringMilliseconds = (clock() - initTime) * 1000.0 / CLOCKS_PER_SEC;
+	std::cout << "Integer keys take: " << intMilliseconds << "ms, string keys take: " 
+		      << stringMilliseconds << "ms" << std::endl;
+
+	// key 2500 gets enough values to span several leaves
+	for(int i = 1; i <= 300 && res; i++) {
+		rid.pageNo = 2500;
+		rid.slotNo = 2500 + i + 1;
+		res = (ibtf->Insert(2500 * step, rid) == OK);
+	}
+
+	std::cout << "RES 1: " << res << std::endl;
+
+	std::cout << "Looking up keys..." << std::endl;
+	RecordID rids[400];
+	int numRids;
+	initTime = clock();
+	for(int n = 0; n < numKeys && res; n++) {
+		int expected = (n == 2500) ? 301 : 1;
+		if(ibtf->Lookup(n * step, rids, 400, numRids) != OK || numRids != expected ||
+		   rids[0].pageNo != n || rids[0].slotNo != n + 1) {
+			std::cerr << "Error: Lookup of " << n * step << " failed." << std::endl;
+			res = false;
+		}
+	}
+	intMilliseconds = (clock() - initTime) * 1000.0 / CLOCKS_PER_SEC;
+
+	initTime = clock();
+	for(int n = 0; n < numKeys && res; n++) {
+		sprintf(skey, "%020lld", n * step);
+		res = (btf->Lookup(skey, rids, 400, numRids) == OK);
+	}
+	stringMilliseconds = (clock() - initTime) * 1000.0 / CLOCKS_PER_SEC;
+	std::cout << "Integer lookups take: " << intMilliseconds << "ms, string lookups take: " 
+		      << stringMilliseconds << "ms" << std::endl;
+
+	if(ibtf->Lookup(step + 1, rids, 400, numRids) != DONE || numRids != 0) {
+		std::cerr << "Error: Lookup found an absent key." << std::endl;
+		res = false;
+	}
+
+	std::cout << "RES 2: " << res << std::endl;
+
+	std::cout << "Scanning..." << std::endl;
+	IntKey low = 1000 * step;
+	IntKey high = 2999 * step;
+	IntKey key, lastKey = -1;
+	int count = 0;
+	IntBTreeFileScan* scan = ibtf->OpenScan(&low, &high);
+	while(scan->GetNext(rid, key) == OK) {
+		if(key < low || key > high || key < lastKey) {
+			std::cerr << "Error: Scan returned " << key << " out of order." << std::endl;
+			res = false;
+		}
+		lastKey = key;
+		count++;
+	}
+	delete scan;
+	if(count != 2300) {
+		std::cerr << "Error: Expected 2300 entries in range, got " << count << std::endl;
+		res = false;
+	}
+
+	std::cout << "RES 3: " << res << std::endl;
+
+	std::cout << "Deleting every other key..." << std::endl;
+	for(int n = 0; n < numKeys && res; n += 2) {
+		rid.pageNo = n;
+		rid.slotNo = n + 1;
+		if(ibtf->Delete(n * step, rid) != OK) {
+			std::cerr << "Error: Failed to delete " << n * step << std::endl;
+			res = false;
+		}
+	}
+	if(ibtf->Delete(0, rid) != FAIL) {
+		std::cerr << "Error: Deleted an absent entry." << std::endl;
+		res = false;
+	}
+
+	count = 0;
+	scan = ibtf->OpenScan(NULL, NULL);
+	while(scan->GetNext(rid, key) == OK) {
+		count++;
+	}
+	delete scan;
+	if(count != numKeys / 2 + 300) {
+		std::cerr << "Error: Expected " << numKeys / 2 + 300 << " entries, got " << count << std::endl;
+		res = false;
+	}
+	if(ibtf->Lookup(2500 * step, rids, 400, numRids) != OK || numRids != 300 ||
+	   ibtf->Lookup(2501 * step, rids, 400, numRids) != OK) {
+		std::cerr << "Error: Lookup after delete failed." << std::endl;
+		res = false;
+	}
+
+	std::cout << "RES 4: " << res << std::endl;
+
+	// keys and values are stored without padding between them
+	if(IntIndexPage::CAPACITY != HEAPPAGE_DATA_SIZE / (int) (sizeof(IntKey) + sizeof(PageID))) {
+		std::cerr << "Error: Index pages hold " << IntIndexPage::CAPACITY << " entries." << std::endl;
+		res = false;
+	}
+
+	// the header records the key type, so neither class opens the other's index
+	unsigned int unpinned = MINIBASE_BM->GetNumOfUnpinnedBuffers();
+	BTreeFile* wrongString = new BTreeFile(status, "BTreeTest14");
+	if(status != FAIL) {
+		std::cerr << "Error: Opened an integer index as a BTreeFile." << std::endl;
+		res = false;
+	}
+	delete wrongString;
+	IntBTreeFile* wrongInt = new IntBTreeFile(status, "BTreeTest14s");
+	if(status != FAIL) {
+		std::cerr << "Error: Opened a string index as an IntBTreeFile." << std::endl;
+		res = false;
+	}
+	delete wrongInt;
+	if(MINIBASE_BM->GetNumOfUnpinnedBuffers() != unpinned) {
+		std::cerr << "Error: A refused open left the header pinned." << std::endl;
+		res = false;
+	}
+
+	// a scan pins each leaf once, plus the pages above the first one
+	int numLeaves = CountIntLeafPages(ibtf);
+	long pins, misses;
+	MINIBASE_BM->ResetStat();
+	scan = ibtf->OpenScan(NULL, NULL);
+	while(scan->GetNext(rid, key) == OK);
+	delete scan;
+	MINIBASE_BM->GetStat(pins, misses);
+	std::cout << "A scan of " << numLeaves << " leaves pins " << pins << " pages" << std::endl;
+	if(pins > numLeaves + MAX_TREE_DEPTH) {
+		std::cerr << "Error: Expected at most " << numLeaves + MAX_TREE_DEPTH << " pins." << std::endl;
+		res = false;
+	}
+
+	std::cout << "RES 5: " << res << std::endl;
+
+	// Deleting every other key left the leaves half full, so they were
+	// merged. Deleting all but one entry collapses the tree to one leaf.
+	std::cout << "Deleting all but one entry..." << std::endl;
+	if(numLeaves <= 0 || numLeaves > 2 * (numKeys / 2 + 300) / IntLeafPage::CAPACITY + 1) {
+		std::cerr << "Error: " << numLeaves << " leaves after deleting half the keys." << std::endl;
+		res = false;
+	}
+	unpinned = MINIBASE_BM->GetNumOfUnpinnedBuffers();
+	for(int i = 1; i <= 300 && res; i++) {
+		rid.pageNo = 2500;
+		rid.slotNo = 2500 + i + 1;
+		if(ibtf->Delete(2500 * step, rid) != OK) {
+			std::cerr << "Error: Failed to delete a value of " << 2500 * step << std::endl;
+			res = false;
+		}
+	}
+	for(int n = 1; n < numKeys - 1 && res; n += 2) {
+		rid.pageNo = n;
+		rid.slotNo = n + 1;
+		if(ibtf->Delete(n * step, rid) != OK) {
+			std::cerr << "Error: Failed to delete " << n * step << std::endl;
+			res = false;
+		}
+	}
+	if(res && (CountIntLeafPages(ibtf) != 1 ||
+	           ibtf->Lookup((numKeys - 1) * step, rids, 400, numRids) != OK || numRids != 1)) {
+		std::cerr << "Error: Expected one leaf holding the last key." << std::endl;
+		res = false;
+	}
+	if(MINIBASE_BM->GetNumOfUnpinnedBuffers() != unpinned) {
+		std::cerr << "Error: Deletes left pages pinned." << std::endl;
+		res = false;
+	}
+
+	std::cout << "RES 6: " << res << std::endl;
+
+	// bulk load the even keys into 70% full pages, then add the odd keys in
+	// one scattered batch
+	std::cout << "Bulk loading and inserting a batch..." << std::endl;
+	IntBTreeFile* loaded = new IntBTreeFile(status, "BTreeTest14b");
+	if (status != OK) {
+		minibase_errors.show_errors();
+		exit(1);
+	}
+	VectorIntBulkLoadSource source;
+	for(int n = 0; n < numKeys; n += 2) {
+		source.Add(n * step, n);
+		for(int i = 1; n == 2500 && i <= 300; i++) {
+			source.Add(n * step, n + i);
+		}
+	}
+	std::vector<IntKey> batchKeys;
+	std::vector<RecordID> batchRids;
+	for(int i = 0; i < numKeys; i++) {
+		int n = (int) ((i * 7919LL) % numKeys);
+		if(n % 2 == 1) {
+			rid.pageNo = n;
+			rid.slotNo = n + 1;
+			batchKeys.push_back(n * step);
+			batchRids.push_back(rid);
+		}
+	}
+
+	unpinned = MINIBASE_BM->GetNumOfUnpinnedBuffers();
+	if(loaded->BulkLoad(source, 0.7) != OK) {
+		std::cerr << "Error: BulkLoad failed." << std::endl;
+		res = false;
+	}
+	// more leaves than full pages would need, but no more than 70% full ones
+	int loadedLeaves = CountIntLeafPages(loaded);
+	int fullLeaves = (int) source.keys.size() / IntLeafPage::CAPACITY + 1;
+	int sparseLeaves = (int) (source.keys.size() / (IntLeafPage::CAPACITY * 0.7)) + 1;
+	if(res && (loadedLeaves <= fullLeaves || loadedLeaves > sparseLeaves)) {
+		std::cerr << "Error: Expected " << fullLeaves << " to " << sparseLeaves 
+			      << " leaves, got " << loadedLeaves << std::endl;
+		res = false;
+	}
+	if(res && loaded->InsertBatch(&batchKeys[0], &batchRids[0], (int) batchKeys.size()) != OK) {
+		std::cerr << "Error: InsertBatch failed." << std::endl;
+		res = false;
+	}
+	for(int n = 0; n < numKeys && res; n++) {
+		int expected = (n == 2500) ? 301 : 1;
+		if(loaded->Lookup(n * step, rids, 400, numRids) != OK || numRids != expected ||
+		   rids[0].pageNo != n || rids[0].slotNo != n + 1) {
+			std::cerr << "Error: Lookup of " << n * step << " after BulkLoad failed." << std::endl;
+			res = false;
+		}
+	}
+	if(res && CountIntLeafPages(loaded) <= loadedLeaves) {
+		std::cerr << "Error: The batch did not split any leaves." << std::endl;
+		res = false;
+	}
+	if(MINIBASE_BM->GetNumOfUnpinnedBuffers() != unpinned) {
+		std::cerr << "Error: BulkLoad or InsertBatch left pages pinned." << std::endl;
+		res = false;
+	}
+
+	std::cout << "RES 7: " << res << std::endl;
+
+	if(ibtf->DestroyFile() != OK || btf->DestroyFile() != OK || loaded->DestroyFile() != OK) {
+		std::cerr << "Error destroying BTreeFile" << std::endl;
+		res = false;
+	}
+
+	delete ibtf;
+	delete btf;
+	delete loaded;
+	return res;
+}
+
+
+//-------------------------------------------------------------------
+// BTreeDriver::TestLegacyHeader
+//
+// Input   : None
+// Output  : None
+// Return  : True if the test passes, false otherwise.
+// Purpose : Checks that a new index marks its header with HEADER_MAGIC,
+//           and that headers written before the fields after the root
+//           page ID existed still open as uncompressed string indexes,
+//           whatever was left on the page there.
+//-------------------------------------------------------------------
+bool BTreeDriver::TestLegacyHeader() {
+	Status status;
+	BTreeFile *btf;
+	bool res = true;
+
+	unsigned int unpinned = MINIBASE_BM->GetNumOfUnpinnedBuffers();
+	btf = new BTreeFile(status, "LegacyHeaderIndex");
+	if (status != OK) {
+		std::cerr << "ERROR: Couldn't create a BTreeFile" << std::endl;
+		minibase_errors.show_errors();
+		return false;
+	}
+	res = InsertRange(btf, 1, 500);
+
+	if(!btf->header->HasMagic() || btf->header->GetKeyType() != HEADER_KEY_STRING) {
+		std::cerr << "Error: A new header isn't marked as a string index." << std::endl;
+		res = false;
+	}
+	delete btf;
+
+	// the header stays pinned only while an index is open
+	if(MINIBASE_BM->GetNumOfUnpinnedBuffers() != unpinned) {
+		std::cerr << "Error: Creating an index left " 
+			      << unpinned - MINIBASE_BM->GetNumOfUnpinnedBuffers() 
+			      << " pages pinned." << std::endl;
+		res = false;
+	}
+
+	std::cout << "RES 1: " << res << std::endl;
+
+	// edit the header of the closed index directly
+	PageID headerID;
+	BTreeHeaderPage* header;
+	if(MINIBASE_DB->GetFileEntry("LegacyHeaderIndex", headerID) != OK) {
+		std::cerr << "Error: Couldn't find the header page." << std::endl;
+		return false;
+	}
+
+	// A legacy header: 0 or other leftovers instead of HEADER_MAGIC, and 
+	// whatever was on the page in the compression flag and key type.
+	int leftovers[] = { 0, HEADER_MAGIC + 1 };
+	for(int i = 0; i < 2 && res; i++) {
+		MINIBASE_BM->PinPage(headerID, (Page*&) header);
+		char* data = (char*) header + sizeof(HeapPage) - HEAPPAGE_DATA_SIZE;
+		*((int*) (data + 2 * sizeof(PageID))) = leftovers[i];
+		header->SetLeafPrefixCompression(true);
+		header->SetKeyType(HEADER_KEY_INT64);
+		MINIBASE_BM->UnpinPage(headerID, DIRTY);
+
+		btf = new BTreeFile(status, "LegacyHeaderIndex");
+		if(status != OK) {
+			std::cerr << "Error: Couldn't open a legacy index." << std::endl;
+			delete btf;
+			return false;
+		}
+		if(btf->header->HasMagic() || btf->header->GetLeafPrefixCompression() 
+		   || btf->header->GetKeyType() != HEADER_KEY_STRING) {
+			std::cerr << "Error: A legacy header reads as compression " 
+				      << btf->header->GetLeafPrefixCompression() << ", key type " 
+				      << btf->header->GetKeyType() << std::endl;
+			res = false;
+		}
+		res = res && TestAbsent(btf, 0) && TestPresent(btf, 1) && TestPresent(btf, 500);
+		delete btf;
+	}
+
+	std::cout << "RES 2: " << res << std::endl;
+
+	btf = new BTreeFile(status, "LegacyHeaderIndex");
+	if(status != OK) {
+		std::cerr << "Error: Couldn't reopen the index." << std::endl;
+		delete btf;
+		return false;
+	}
+	if(btf->DestroyFile() != OK) {
+		std::cerr << "Error destroying BTreeFile" << std::endl;
+		res = false;
+	}
+
+	delete btf;
+	return res;
+}
+
+
+//-------------------------------------------------------------------
+// BTreeDriver::TestIndexRightLinks
+//
+// Input   : None
+// Output  : None
+// Return  : True if the test passes, false otherwise.
+// Purpose : Checks that index pages, like leaf pages, are linked to 
+//           their right sibling after inserts, batch inserts, bulk 
+//           loads and deletes. 
+//-------------------------------------------------------------------
+bool BTreeDriver::TestIndexRightLinks() {
+	Status status;
+	BTreeFile *inserted;
+	BTreeFile *batched;
+	BTreeFile *loaded;
+	bool res = true;
+
+	inserted = new BTreeFile(status, "BTreeTest16a");
+	batched = new BTreeFile(status, "BTreeTest16b");
+	loaded = new BTreeFile(status, "BTreeTest16c");
+	if (status != OK) {
+		minibase_errors.show_errors();
+		exit(1);
+	}
+	std::cout << "Starting Index Right Link Test..." << std::endl;
+
+	// long keys, so the trees have several index levels
+	const int numKeys = 4000;
+	const int pad = 30;
+	std::vector<std::string> keys;
+	std::vector<RecordID> rids;
+	char skey[MAX_KEY_LENGTH];
+	for(int i = 0; i < numKeys; i++) {
+		int keyNum = (i * 7919) % numKeys + 1;
+		RecordID rid;
+		rid.pageNo = keyNum + 1;
+		rid.slotNo = keyNum + 2;
+		toString(keyNum, skey, pad);
+		keys.push_back(skey);
+		rids.push_back(rid);
+	}
+	std::vector<const char*> keyPtrs;
+	for(int i = 0; i < numKeys; i++) {
+		keyPtrs.push_back(keys[i].c_str());
+	}
+
+	std::cout << "Inserting " << numKeys << " keys..." << std::endl;
+	for(int i = 0; i < numKeys && res; i++) {
+		res = (inserted->Insert(keyPtrs[i], rids[i]) == OK);
+	}
+	res = res && InsertDuplicates(inserted, 2000, 200, 1, pad);
+	res = res && TestRightLinks(inserted);
+
+	std::cout << "RES 1: " << res << std::endl;
+
+	std::cout << "Inserting in batches..." << std::endl;
+	for(int i = 0; i < numKeys && res; i += 500) {
+		res = (batched->InsertBatch(&keyPtrs[i], &rids[i], 500) == OK);
+	}
+	res = res && TestRightLinks(batched);
+
+	std::cout << "RES 2: " << res << std::endl;
+
+	std::cout << "Bulk loading..." << std::endl;
+	VectorBulkLoadSource source;
+	for(int i = 1; i <= numKeys; i++) {
+		toString(i, skey, pad);
+		source.Add(skey, i);
+	}
+	res = res && (loaded->BulkLoad(source, 0.7) == OK);
+	res = res && TestRightLinks(loaded);
+
+	std::cout << "RES 3: " << res << std::endl;
+
+	std::cout << "Deleting..." << std::endl;
+	res = res && DeleteStride(inserted, 1, numKeys, 2, pad);
+	res = res && TestRightLinks(inserted);
+	res = res && DeleteStride(inserted, 2, numKeys - 100, 2, pad);
+	res = res && TestRightLinks(inserted);
+	res = res && TestPresent(inserted, numKeys, 1, pad);
+
+	std::cout << "RES 4: " << res << std::endl;
+
+	if(inserted->DestroyFile() != OK || batched->DestroyFile() != OK || loaded->DestroyFile() != OK) {
+		std::cerr << "Error destroying BTreeFile" << std::endl;
+		res = false;
+	}
+
+	delete inserted;
+	delete batched;
+	delete loaded;
+	return res;
+}
+
+
+//-------------------------------------------------------------------
+// BTreeDriver::TestScanDescent
+//
+// Input   : None
+// Output  : None
+// Return  : True if the test passes, false otherwise.
+// Purpose : Checks that opening a scan at a key descends straight to 
+//           the leaf holding it, pinning each level once, instead of 
+//           starting further left and walking the leaf chain. 
+//-------------------------------------------------------------------
+bool BTreeDriver::TestScanDescent() {
+	Status status;
+	BTreeFile *btf;
+	bool res = true;
+	clock_t initTime;
+	double timeInMilliseconds;
+
+	btf = new BTreeFile(status, "BTreeTest17");
+	if (status != OK) {
+		minibase_errors.show_errors();
+		exit(1);
+	}
+	std::cout << "Starting Scan Descent Test..." << std::endl;
+
+	const int numKeys = 10000;
+	res = InsertRange(btf, 1, numKeys, 1, 8);
+
+	int height = TreeHeight(btf);
+
+	std::cout << "Opening " << numKeys << " exact match scans on a tree of height " 
+		      << height << "..." << std::endl;
+	char skey[MAX_KEY_LENGTH];
+	long pins, misses;
+	MINIBASE_BM->ResetStat();
+	initTime = clock();
+	for(int i = 1; i <= numKeys && res; i++) {
+		toString(i, skey, 8);
+		BTreeFileScan* scan = btf->OpenScan(skey, skey);
+		res = TestScanCount(scan, 1);
+		delete scan;
+	}
+	timeInMilliseconds = (clock() - initTime) * 1000.0 / CLOCKS_PER_SEC;
+	MINIBASE_BM->GetStat(pins, misses);
+	std::cout << "Scans take: " << timeInMilliseconds << "ms, " 
+		      << (double) pins / numKeys << " pins per scan" << std::endl;
+
+	// The descent leaves the leaf pinned for the scan, and only reading 
+	// past the match can pin another page, the next leaf.
+	if(pins > (long) numKeys * (height + 1)) {
+		std::cerr << "Error: Scans pinned " << pins << " pages." << std::endl;
+		res = false;
+	}
+
+	if(btf->DestroyFile() != OK) {
+		std::cerr << "Error destroying BTreeFile" << std::endl;
+		res = false;
+	}
+
+	delete btf;
+	return res;
+}
+
+
+//-------------------------------------------------------------------
+// BTreeDriver::TestPinFailures
+//
+// Input   : None
+// Output  : None
+// Return  : True if the test passes, false otherwise.
+// Purpose : Fills the buffer pool so that inserts and deletes fail part 
+//           way down the tree, and checks that every page they pinned 
+//           is unpinned again when they give up, and that deletes report
+//           the rebalances they could not do. 
+//-------------------------------------------------------------------
+bool BTreeDriver::TestPinFailures() {
+	Status status;
+	BTreeFile *btf;
+	bool res = true;
+
+	btf = new BTreeFile(status, "BTreeTest18");
+	if (status != OK) {
+		minibase_errors.show_errors();
+		exit(1);
+	}
+	std::cout << "Starting Pin Failure Test..." << std::endl;
+
+	res = InsertRange(btf, 1, 2000, 1, 5);
+	int height = TreeHeight(btf);
+	unsigned int unpinned = MINIBASE_BM->GetNumOfUnpinnedBuffers();
+
+	// pin all but enough frames for one path down the tree
+	std::cout << "Filling the buffer pool..." << std::endl;
+	std::vector<PageID> fillers;
+	while(MINIBASE_BM->GetNumOfUnpinnedBuffers() > (unsigned int) height) {
+		PageID pid;
+		Page* page;
+		if(MINIBASE_BM->NewPage(pid, page) != OK) {
+			break;
+		}
+		fillers.push_back(pid);
+	}
+
+	std::cout << "Inserting and deleting with a full pool..." << std::endl;
+	char skey[MAX_KEY_LENGTH];
+	RecordID rid;
+	std::vector<int> failedKeys;
+	for(int i = 2001; i <= 3000 && failedKeys.size() < 10; i++) {
+		toString(i, skey, 5);
+		rid.pageNo = i + 1;
+		rid.slotNo = i + 2;
+		if(btf->Insert(skey, rid) != OK) {
+			failedKeys.push_back(i);
+		}
+	}
+	// DONE removes the entry, but could not pin the pages to rebalance
+	std::vector<bool> deleted(2001, false);
+	int notRebalanced = 0;
+	for(int i = 1; i <= 2000; i++) {
+		toString(i, skey, 5);
+		rid.pageNo = i + 1;
+		rid.slotNo = i + 2;
+		Status s = btf->Delete(skey, rid);
+		deleted[i] = (s != FAIL);
+		if(s == DONE) {
+			notRebalanced++;
+		}
+	}
+	std::cout << failedKeys.size() << " inserts failed, " << notRebalanced 
+		      << " deletes were not rebalanced" << std::endl;
+	if(failedKeys.empty()) {
+		std::cerr << "Error: Expected inserts to fail with a full pool." << std::endl;
+		res = false;
+	}
+	if(notRebalanced == 0) {
+		std::cerr << "Error: Expected rebalances to fail with a full pool." << std::endl;
+		res = false;
+	}
+
+	for(unsigned int i = 0; i < fillers.size(); i++) {
+		MINIBASE_BM->UnpinPage(fillers[i], CLEAN);
+		MINIBASE_BM->FreePage(fillers[i]);
+	}
+	if(MINIBASE_BM->GetNumOfUnpinnedBuffers() != unpinned) {
+		std::cerr << "Error: " << unpinned - MINIBASE_BM->GetNumOfUnpinnedBuffers() 
+			      << " pages were left pinned." << std::endl;
+		delete btf;
+		return false;
+	}
+
+	// a delete that failed left its key, and one that succeeded removed it
+	for(int i = 1; i <= 2000 && res; i++) {
+		RecordID rids[2];
+		int numRids;
+		toString(i, skey, 5);
+		if((btf->Lookup(skey, rids, 2, numRids) == OK) == deleted[i]) {
+			std::cerr << "Error: Delete of " << skey << " returned " 
+				      << (deleted[i] ? "OK or DONE" : "FAIL") << " but the key is " 
+				      << (deleted[i] ? "still there." : "gone.") << std::endl;
+			res = false;
+		}
+	}
+
+	std::cout << "RES 1: " << res << std::endl;
+
+	// the tree is still usable once there is room again
+	for(unsigned int i = 0; i < failedKeys.size() && res; i++) {
+		res = InsertKey(btf, failedKeys[i], 1, 5);
+	}
+	res = res && InsertRange(btf, 1, 100, 1, 5);
+	res = res && TestPresent(btf, 50, 1, 5);
+	res = res && TestPresent(btf, 2001, 1, 5);
+	res = res && TestPresent(btf, failedKeys.back(), 1, 5);
+
+	std::cout << "RES 2: " << res << std::endl;
+
+	if(btf->DestroyFile() != OK) {
+		std::cerr << "Error destroying BTreeFile" << std::endl;
+		res = false;
+	}
+
+	delete btf;
+	return res;
+}
@@ -0,0 +1,456 @@
+#include "IntBTreeFile.h"
+#include "db.h"
+#include "bufmgr.h"
+#include "system_defs.h"
+
+#include <iostream>
+#include <climits>
+using namespace std;
+
+//-------------------------------------------------------------------
+// IntBTreeFile::IntBTreeFile
+//
+// Input   : filename - filename of an index.
+// Output  : returnStatus - status of execution of constructor.
+//           OK if successful, FAIL otherwise, or if the existing index
+//           has string keys.
+// Purpose : Open the index file, if it exists. Otherwise, create a new
+//           index with the specified filename, as BTreeFile does.
+//-------------------------------------------------------------------
+IntBTreeFile::IntBTreeFile(Status& returnStatus, const char *filename)
+	: BTreeCore<IntKeyTraits>(returnStatus, filename, HEADER_KEY_INT64, false) {
+}
+
+
+//-------------------------------------------------------------------
+// IntKeyTraits::InitLeaf
+//
+// Input   : page - the new leaf page
+//           pid - its page ID
+//           header - the header of the index
+// Output  : None
+// Return  : None
+// Purpose : Initializes an empty leaf.
+//-------------------------------------------------------------------
+void IntKeyTraits::InitLeaf(IntLeafPage* page, PageID pid, BTreeHeaderPage* header) {
+	page->Init(pid, LEAF_PAGE);
+}
+
+
+//-------------------------------------------------------------------
+// IntKeyTraits::FindChild
+//
+// Input   : indexPage - the index page to route through
+//           key - the key being searched for
+//           strict - whether to skip separators equal to key
+// Output  : None
+// Return  : The child of indexPage that key belongs under.
+//-------------------------------------------------------------------
+PageID IntKeyTraits::FindChild(IntIndexPage* indexPage, IntKey key, bool strict) {
+	return indexPage->FindChild(key, strict);
+}
+
+
+//-------------------------------------------------------------------
+// IntKeyTraits::GetChildren
+//
+// Input   : indexPage - the index page
+// Output  : children - gets every child of indexPage, leftmost first
+// Return  : None
+//-------------------------------------------------------------------
+void IntKeyTraits::GetChildren(IntIndexPage* indexPage, std::vector<PageID>& children) {
+	children.push_back(indexPage->GetPrevPage());
+	for (int i = 0; i < indexPage->GetNumEntries(); i++) {
+		children.push_back(indexPage->GetValue(i));
+	}
+}
+
+
+//-------------------------------------------------------------------
+// IntKeyTraits::FindKeyChildren
+//
+// Input   : indexPage - the index page
+//           key - the key being deleted
+//           maxChildren - the number of entries children has room for
+// Output  : children - the children that can hold values of key, in order
+// Return  : The number of children found.
+// Purpose : Values of key can start in the last child with a smaller key
+//           and continue through each child of key itself.
+//-------------------------------------------------------------------
+int IntKeyTraits::FindKeyChildren(IntIndexPage* indexPage, IntKey key, PageID *children, int maxChildren) {
+	int numChildren = 0;
+	int end = indexPage->UpperBound(key);
+	for (int pos = indexPage->LowerBound(key) - 1; pos < end && numChildren < maxChildren; pos++) {
+		children[numChildren++] = (pos < 0) ? indexPage->GetPrevPage() : indexPage->GetValue(pos);
+	}
+	return numChildren;
+}
+
+
+//-------------------------------------------------------------------
+// IntKeyTraits::FindSiblings
+//
+// Input   : parent - the index page
+//           childPid - a child of parent
+// Output  : leftPid, rightPid - childPid and its right sibling, or its left
+//                               sibling and childPid if it is the last child
+//           sep - the key of rightPid in parent
+// Return  : false if childPid is the only child of parent.
+//-------------------------------------------------------------------
+bool IntKeyTraits::FindSiblings(IntIndexPage* parent, PageID childPid, PageID& leftPid, PageID& rightPid, IntKey& sep) {
+	int numEntries = parent->GetNumEntries();
+	if (numEntries == 0) {
+		return false;
+	}
+
+	// position -1 is the prevPage child
+	int childPos = -1;
+	while (childPos < numEntries - 1 && childPid != ((childPos < 0) ? parent->GetPrevPage() : parent->GetValue(childPos))) {
+		childPos++;
+	}
+
+	// sepPos is the position of the right page of the pair
+	int sepPos = (childPos < numEntries - 1) ? childPos + 1 : childPos;
+	leftPid = (sepPos == 0) ? parent->GetPrevPage() : parent->GetValue(sepPos - 1);
+	rightPid = parent->GetValue(sepPos);
+	sep = parent->GetKey(sepPos);
+	return true;
+}
+
+
+//-------------------------------------------------------------------
+// IntKeyTraits::SplitLeafEntries
+//
+// Input   : oldPage - the full leaf
+//           newPage - an empty leaf
+//           key, rid - the entry that did not fit
+// Output  : None
+// Return  : OK
+// Purpose : Moves the upper half of oldPage to newPage in one block copy
+//           and inserts the entry into the half it belongs to.
+//-------------------------------------------------------------------
+Status IntKeyTraits::SplitLeafEntries(IntLeafPage* oldPage, IntLeafPage* newPage, IntKey key, const RecordID rid) {
+	oldPage->MoveUpperHalf(newPage);
+	return ((key < newPage->GetKey(0)) ? oldPage : newPage)->Insert(key, rid);
+}
+
+
+//-------------------------------------------------------------------
+// IntKeyTraits::LeafSeparator
+//
+// Input   : oldPage, newPage - the two halves of a split leaf
+// Output  : separator - the first key of newPage
+// Return  : None
+//-------------------------------------------------------------------
+void IntKeyTraits::LeafSeparator(IntLeafPage* oldPage, IntLeafPage* newPage, IntKey& separator) {
+	separator = newPage->GetKey(0);
+}
+
+
+//-------------------------------------------------------------------
+// IntKeyTraits::SplitIndexEntries
+//
+// Input   : oldPage - the full index page
+//           newPage - an empty index page
+//           key, pid - the child that did not fit
+//           leftPid - the child pid was split off from
+// Output  : upKey - the key that moves up to the parent
+// Return  : OK
+// Purpose : Moves the upper half of oldPage to newPage. The first key of
+//           the new page moves up, and its child becomes the leftmost
+//           child of the new page.
+//-------------------------------------------------------------------
+Status IntKeyTraits::SplitIndexEntries(IntIndexPage* oldPage, IntIndexPage* newPage, IntKey key, PageID pid,
+                                       PageID leftPid, IntKey& upKey) {
+	oldPage->MoveUpperHalf(newPage);
+
+	PageID firstChild;
+	newPage->PopFirst(upKey, firstChild);
+	newPage->SetPrevPage(firstChild);
+
+	// The new child goes right after the child it was split off from. With
+	// a key equal to the one moving up, that is the new page only if
+	// leftPid is there, possibly as its leftmost child.
+	bool toNew = (upKey < key) || 
+	             (key == upKey && (leftPid == firstChild || newPage->Contains(key, leftPid)));
+	return (toNew ? newPage : oldPage)->InsertAfter(key, pid, leftPid);
+}
+
+
+//-------------------------------------------------------------------
+// IntKeyTraits::GetLastEntry
+//
+// Input   : indexPage - a non-empty index page
+// Output  : key, pid - the last entry on the page
+// Return  : OK
+//-------------------------------------------------------------------
+Status IntKeyTraits::GetLastEntry(IntIndexPage* indexPage, IntKey& key, PageID& pid) {
+	int last = indexPage->GetNumEntries() - 1;
+	key = indexPage->GetKey(last);
+	pid = indexPage->GetValue(last);
+	return OK;
+}
+
+
+//-------------------------------------------------------------------
+// IntKeyTraits::LeavesFit
+//
+// Input   : left, right - adjacent leaves
+// Output  : None. merged is not used, entries are counted instead.
+// Return  : true if right can be merged into left.
+//-------------------------------------------------------------------
+bool IntKeyTraits::LeavesFit(IntLeafPage* left, IntLeafPage* right, IntLeafPage* merged) {
+	return left->GetNumEntries() + right->GetNumEntries() <= IntLeafPage::CAPACITY;
+}
+
+
+//-------------------------------------------------------------------
+// IntKeyTraits::MergeLeaves
+//
+// Input   : left, right - adjacent leaves that fit on one page
+// Output  : None
+// Return  : None
+// Purpose : Moves the entries of right to the end of left in one block copy.
+//-------------------------------------------------------------------
+void IntKeyTraits::MergeLeaves(IntLeafPage* left, IntLeafPage* right, IntLeafPage* merged) {
+	right->MoveEntries(0, right->GetNumEntries(), left, left->GetNumEntries());
+}
+
+
+//-------------------------------------------------------------------
+// IntKeyTraits::IndexPagesFit
+//
+// Input   : left, right - adjacent index pages
+//           sep - the key of right in their parent
+// Output  : None. merged is not used, entries are counted instead.
+// Return  : true if right, and sep over its leftmost child, can be merged
+//           into left.
+//-------------------------------------------------------------------
+bool IntKeyTraits::IndexPagesFit(IntIndexPage* left, IntKey sep, IntIndexPage* right, IntIndexPage* merged) {
+	return left->GetNumEntries() + 1 + right->GetNumEntries() <= IntIndexPage::CAPACITY;
+}
+
+
+//-------------------------------------------------------------------
+// IntKeyTraits::MergeIndexPages
+//
+// Input   : left, right - adjacent index pages that fit on one page
+//           sep - the key of right in their parent
+// Output  : None
+// Return  : None
+// Purpose : The separator comes down over the leftmost child of right, and
+//           the entries of right follow it.
+//-------------------------------------------------------------------
+void IntKeyTraits::MergeIndexPages(IntIndexPage* left, IntKey sep, IntIndexPage* right, IntIndexPage* merged) {
+	int numLeft = left->GetNumEntries();
+	left->InsertAt(numLeft, sep, right->GetPrevPage());
+	right->MoveEntries(0, right->GetNumEntries(), left, numLeft + 1);
+}
+
+
+//-------------------------------------------------------------------
+// IntKeyTraits::RedistributeLeaves
+//
+// Input   : left, right - adjacent leaves that do not fit on one page
+// Output  : newSep - the new separator of right, its first key
+// Return  : None
+// Purpose : Evens out the entries of two leaves in one block copy.
+//-------------------------------------------------------------------
+void IntKeyTraits::RedistributeLeaves(IntLeafPage* left, IntLeafPage* right, IntKey& newSep) {
+	int numLeft = left->GetNumEntries();
+	int numRight = right->GetNumEntries();
+	int leftTarget = (numLeft + numRight) / 2;
+	if (numLeft < leftTarget) {
+		right->MoveEntries(0, leftTarget - numLeft, left, numLeft);
+	} else {
+		left->MoveEntries(leftTarget, numLeft - leftTarget, right, 0);
+	}
+	newSep = right->GetKey(0);
+}
+
+
+//-------------------------------------------------------------------
+// IntKeyTraits::RedistributeIndexPages
+//
+// Input   : left, right - adjacent index pages that do not fit on one page
+//           sep - the key of right in their parent
+// Output  : newSep - the new separator of right
+// Return  : None
+// Purpose : Evens out the entries of two index pages. Entries move through
+//           the parent: the separator comes down with the leftmost child
+//           of right, and a key of the page that gives entries goes up in
+//           its place.
+//-------------------------------------------------------------------
+void IntKeyTraits::RedistributeIndexPages(IntIndexPage* left, IntKey sep, IntIndexPage* right, IntKey& newSep) {
+	int numLeft = left->GetNumEntries();
+	int numRight = right->GetNumEntries();
+	int leftTarget = (numLeft + numRight) / 2;
+	newSep = sep;
+
+	if (numLeft > leftTarget) {
+		// the separator comes down as the first key of right, over its
+		// old leftmost child, and the entries after leftTarget follow it.
+		// The entry at leftTarget goes up.
+		right->InsertAt(0, sep, right->GetPrevPage());
+		left->MoveEntries(leftTarget + 1, numLeft - leftTarget - 1, right, 0);
+		right->SetPrevPage(left->GetValue(leftTarget));
+		newSep = left->GetKey(leftTarget);
+		left->DeleteAt(leftTarget);
+	} else if (numLeft < leftTarget) {
+		// the separator and the leftmost child of right move to left,
+		// followed by the first entries of right. The next key of right 
+		// goes up, and its child becomes the leftmost child of right.
+		int moved = leftTarget - numLeft;
+		left->InsertAt(numLeft, sep, right->GetPrevPage());
+		right->MoveEntries(0, moved - 1, left, numLeft + 1);
+		right->SetPrevPage(right->GetValue(0));
+		newSep = right->GetKey(0);
+		right->DeleteAt(0);
+	}
+}
+
+
+//-------------------------------------------------------------------
+// IntBTreeFile::FindLeaf
+//
+// Input   : key - the key to search for
+//           strict - whether to descend left of separators equal to key
+// Output  : leafGuard - holds the pin on leafPage for the caller
+//           leafPage - the leaf page the search ends at
+// Return  : OK if successful, FAIL otherwise.
+// Purpose : Descends from the root to a leaf, pinning one page at a time.
+//           Values of a key can span several leaves, and a strict search 
+//           finds the first of them.
+//-------------------------------------------------------------------
+Status IntBTreeFile::FindLeaf(IntKey key, bool strict, PageGuard& leafGuard, IntLeafPage*& leafPage) {
+	ResizableRecordPage* currPage;
+	PageID currPid = header->GetRootPageID();
+
+	while (true) {
+		PIN_GUARD(leafGuard, currPid, currPage);
+		if (currPage->GetType() != INDEX_PAGE) {
+			leafPage = (IntLeafPage*) currPage;
+			return OK;
+		}
+		currPid = ((IntIndexPage*) currPage)->FindChild(key, strict);
+	}
+}
+
+
+//-------------------------------------------------------------------
+// IntBTreeFile::Lookup
+//
+// Input   : key - the key to look up.
+//           maxRids - the number of record IDs rids has room for.
+// Output  : rids - the first maxRids record IDs stored with key.
+//           numRids - the number of record IDs stored with key, which
+//                     may be more than maxRids.
+// Return  : OK if key is in the index, DONE if it is not, FAIL on error.
+// Purpose : Exact-match read, as BTreeFile::Lookup.
+//-------------------------------------------------------------------
+Status IntBTreeFile::Lookup(IntKey key, RecordID *rids, int maxRids, int& numRids) {
+	numRids = 0;
+	if (header->GetRootPageID() == INVALID_PAGE) {
+		return DONE;
+	}
+
+	PageGuard leafGuard;
+	IntLeafPage* leafPage;
+	if (this->FindLeaf(key, true, leafGuard, leafPage) != OK) {
+		return FAIL;
+	}
+
+	while (true) {
+		int numEntries = leafPage->GetNumEntries();
+		int pos = leafPage->LowerBound(key);
+		for (; pos < numEntries && leafPage->GetKey(pos) == key; pos++) {
+			if (numRids < maxRids) {
+				rids[numRids] = leafPage->GetValue(pos);
+			}
+			numRids++;
+		}
+
+		// values of key may continue on the next page
+		PageID nextPid = leafPage->GetNextPage();
+		if (pos < numEntries || nextPid == INVALID_PAGE) {
+			break;
+		}
+		PIN_GUARD(leafGuard, nextPid, leafPage);
+	}
+
+	return (numRids > 0) ? OK : DONE;
+}
+
+
+//-------------------------------------------------------------------
+// IntBTreeFile::OpenScan
+//
+// Input   : lowKey, highKey - pointers to the bounds of the range to
+//                             scan. NULL leaves that end open, as in
+//                             BTreeFile::OpenScan.
+// Output  : None
+// Return  : A pointer to IntBTreeFileScan class.
+// Purpose : Initialize a scan.
+//-------------------------------------------------------------------
+IntBTreeFileScan* IntBTreeFile::OpenScan(const IntKey* lowKey, const IntKey* highKey) {
+	IntBTreeFileScan* newScan = new IntBTreeFileScan();
+	newScan->hasLowKey = (lowKey != NULL);
+	newScan->hasHighKey = (highKey != NULL);
+	newScan->lowKey = (lowKey != NULL) ? *lowKey : LLONG_MIN;
+	newScan->highKey = (highKey != NULL) ? *highKey : LLONG_MAX;
+	newScan->currentPos = 0;
+
+	// the smallest key descends along the leftmost children. The leaf 
+	// found stays pinned by the scan.
+	newScan->done = (header->GetRootPageID() == INVALID_PAGE ||
+		this->FindLeaf(newScan->lowKey, true, newScan->pageGuard, newScan->currentPage) != OK);
+	return newScan;
+}
+
+
+//-------------------------------------------------------------------
+// IntBTreeFile::PrintWhole
+//
+// Input   : None
+// Output  : None
+// Return  : OK if successful, FAIL otherwise.
+// Purpose : Prints every page of the tree.
+//-------------------------------------------------------------------
+Status IntBTreeFile::PrintWhole() {
+	PageID rootPid = header->GetRootPageID();
+	if (rootPid == INVALID_PAGE) {
+		cout << "Empty tree" << endl;
+		return OK;
+	}
+	return this->PrintTree(rootPid);
+}
+
+
+//-------------------------------------------------------------------
+// IntBTreeFile::PrintTree
+//
+// Input   : pageID - the root of the subtree to print
+// Output  : None
+// Return  : OK if successful, FAIL otherwise.
+//-------------------------------------------------------------------
+Status IntBTreeFile::PrintTree(PageID pageID) {
+	ResizableRecordPage* page;
+	PIN(pageID, page);
+
+	if (page->GetType() == INDEX_PAGE) {
+		IntIndexPage* indexPage = (IntIndexPage*) page;
+		indexPage->PrintPage();
+		for (int i = -1; i < indexPage->GetNumEntries(); i++) {
+			PageID childPid = (i < 0) ? indexPage->GetPrevPage() : indexPage->GetValue(i);
+			if (this->PrintTree(childPid) != OK) {
+				UNPIN(pageID, CLEAN);
+				return FAIL;
+			}
+		}
+	} else {
+		((IntLeafPage*) page)->PrintPage();
+	}
+
+	UNPIN(pageID, CLEAN);
+	return OK;
+}
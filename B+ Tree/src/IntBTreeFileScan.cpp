@@ -0,0 +1,112 @@
+#include "minirel.h"
+#include "bufmgr.h"
+#include "db.h"
+#include "new_error.h"
+#include "IntBTreeFile.h"
+#include "IntBTreeFileScan.h"
+
+//-------------------------------------------------------------------
+// IntBTreeFileScan::~IntBTreeFileScan
+//
+// Input   : None
+// Output  : None
+// Purpose : Clean Up the B+ tree scan. A scan that has not finished 
+//           still holds a pin on its current leaf, which pageGuard 
+//           releases.
+//-------------------------------------------------------------------
+IntBTreeFileScan::~IntBTreeFileScan() {
+}
+
+
+//-------------------------------------------------------------------
+// IntBTreeFileScan::IntBTreeFileScan
+//
+// Input   : None
+// Output  : None
+// Purpose : Constructs a new scan. Only IntBTreeFile::OpenScan
+//           creates scans.
+//-------------------------------------------------------------------
+IntBTreeFileScan::IntBTreeFileScan() {
+	done = true;
+	currentPage = NULL;
+	currentPos = 0;
+}
+
+
+//-------------------------------------------------------------------
+// IntBTreeFileScan::GetNext
+//
+// Input   : None
+// Output  : rid  - record id of the scanned record.
+//           key  - its key.
+// Purpose : Return the next record from the B+-tree index.
+// Return  : OK if successful, DONE if no more records to read
+//           or if high key has been passed.
+// Note    : As in BTreeFileScan, the current leaf stays pinned until the
+//           scan moves on to the next leaf, so each leaf is pinned once.
+//-------------------------------------------------------------------
+Status IntBTreeFileScan::GetNext(RecordID & rid, IntKey& key) {
+	while (!done) {
+		if (currentPos < currentPage->GetNumEntries()) {
+			key = currentPage->GetKey(currentPos);
+			rid = currentPage->GetValue(currentPos);
+			currentPos++;
+
+			if (hasHighKey && highKey < key) { // exceeded upper bound
+				return _EndScan();
+			}
+			if (hasLowKey && key < lowKey) { // haven't reached range yet
+				continue;
+			}
+			return OK;
+		}
+
+		// done scanning current page, get next page
+		PageID nextPid = currentPage->GetNextPage();
+		if (nextPid == INVALID_PAGE) { // no more pages
+			return _EndScan();
+		}
+		currentPos = 0;
+		if (pageGuard.Pin(nextPid, currentPage) != OK) {
+			done = true;
+			return FAIL;
+		}
+	}
+	return DONE;
+}
+
+
+//-------------------------------------------------------------------
+// IntBTreeFileScan::DeleteCurrent
+//
+// Input   : None
+// Output  : None
+// Purpose : Delete the entry most recently returned by GetNext.
+// Return  : OK if successful, DONE if the scan is over, FAIL otherwise.
+//-------------------------------------------------------------------
+Status IntBTreeFileScan::DeleteCurrent() {
+	if (done) {
+		return DONE;
+	}
+	if (currentPos == 0) {
+		return FAIL;
+	}
+
+	Status s = currentPage->Delete(currentPage->GetKey(currentPos - 1), currentPage->GetValue(currentPos - 1));
+	if (s == OK) {
+		currentPos--;
+		pageGuard.SetDirty(); // the page is unpinned dirty when the scan leaves it
+	}
+	return s;
+}
+
+
+//function used to end the scan; releases the current page
+Status IntBTreeFileScan::_EndScan() {
+	done = true;
+	currentPage = NULL;
+	if (pageGuard.Release() != OK) {
+		return FAIL;
+	}
+	return DONE;
+}
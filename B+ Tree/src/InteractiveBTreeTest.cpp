@@ -116,6 +116,102 @@ Status InteractiveBTreeTest::RunTests(istream &in) {
 					std::cerr << "PASSED Test " << testNum << std::endl;
 				}
 				break;
+			case 7:
+				if(!BTreeDriver::TestKeyCompare()) {
+					std::cerr << "FAILED Test " << testNum << std::endl;
+				}
+				else {
+					std::cerr << "PASSED Test " << testNum << std::endl;
+				}
+				break;
+			case 8:
+				if(!BTreeDriver::TestPrefixCompression()) {
+					std::cerr << "FAILED Test " << testNum << std::endl;
+				}
+				else {
+					std::cerr << "PASSED Test " << testNum << std::endl;
+				}
+				break;
+			case 9:
+				if(!BTreeDriver::TestSeparatorTruncation()) {
+					std::cerr << "FAILED Test " << testNum << std::endl;
+				}
+				else {
+					std::cerr << "PASSED Test " << testNum << std::endl;
+				}
+				break;
+			case 10:
+				if(!BTreeDriver::TestBulkLoad()) {
+					std::cerr << "FAILED Test " << testNum << std::endl;
+				}
+				else {
+					std::cerr << "PASSED Test " << testNum << std::endl;
+				}
+				break;
+			case 11:
+				if(!BTreeDriver::TestInsertBatch()) {
+					std::cerr << "FAILED Test " << testNum << std::endl;
+				}
+				else {
+					std::cerr << "PASSED Test " << testNum << std::endl;
+				}
+				break;
+			case 12:
+				if(!BTreeDriver::TestLookup()) {
+					std::cerr << "FAILED Test " << testNum << std::endl;
+				}
+				else {
+					std::cerr << "PASSED Test " << testNum << std::endl;
+				}
+				break;
+			case 13:
+				if(!BTreeDriver::TestDelete()) {
+					std::cerr << "FAILED Test " << testNum << std::endl;
+				}
+				else {
+					std::cerr << "PASSED Test " << testNum << std::endl;
+				}
+				break;
+			case 14:
+				if(!BTreeDriver::TestIntKeys()) {
+					std::cerr << "FAILED Test " << testNum << std::endl;
+				}
+				else {
+					std::cerr << "PASSED Test " << testNum << std::endl;
+				}
+				break;
+			case 15:
+				if(!BTreeDriver::TestLegacyHeader()) {
+					std::cerr << "FAILED Test " << testNum << std::endl;
+				}
+				else {
+					std::cerr << "PASSED Test " << testNum << std::endl;
+				}
+				break;
+			case 16:
+				if(!BTreeDriver::TestIndexRightLinks()) {
+					std::cerr << "FAILED Test " << testNum << std::endl;
+				}
+				else {
+					std::cerr << "PASSED Test " << testNum << std::endl;
+				}
+				break;
+			case 17:
+				if(!BTreeDriver::TestScanDescent()) {
+					std::cerr << "FAILED Test " << testNum << std::endl;
+				}
+				else {
+					std::cerr << "PASSED Test " << testNum << std::endl;
+				}
+				break;
+			case 18:
+				if(!BTreeDriver::TestPinFailures()) {
+					std::cerr << "FAILED Test " << testNum << std::endl;
+				}
+				else {
+					std::cerr << "PASSED Test " << testNum << std::endl;
+				}
+				break;
 			}
 
 		}
@@ -0,0 +1,26 @@
+#include <string.h>
+
+#include "KeyCompare.h"
+
+
+//-------------------------------------------------------------------
+// KeySearch
+//
+// Input   : key,     the search key.
+//           keys,    numKeys keys in ascending order.
+// Output  : found,   true if keys[result] equals key.
+// Return  : The number of keys smaller than key.
+// Purpose : Searches the last few keys left by a binary search one at
+//           a time, which is cheaper than more halving steps.
+//-------------------------------------------------------------------
+int KeySearch(const char* key, const char* const* keys, int numKeys, bool& found) {
+	for(int i = 0; i < numKeys; i++) {
+		int cmp = KeyCompare(keys[i], key);
+		if(cmp >= 0) {
+			found = (cmp == 0);
+			return i;
+		}
+	}
+	found = false;
+	return numKeys;
+}
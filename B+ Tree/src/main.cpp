@@ -17,6 +17,18 @@ void printHelp() {
 	cout << "\tTest 4: Test a large workload." << endl;
 	cout << "\tTest 5: Test modified inserts." << endl;
 	cout << "\tTest 6: Added performance test." << endl;
+	cout << "\tTest 7: Key comparison benchmark." << endl;
+	cout << "\tTest 8: Test prefix compressed leaf pages." << endl;
+	cout << "\tTest 9: Test truncated separator keys." << endl;
+	cout << "\tTest 10: Test bulk loading." << endl;
+	cout << "\tTest 11: Test batched inserts." << endl;
+	cout << "\tTest 12: Test point lookups." << endl;
+	cout << "\tTest 13: Test deletes." << endl;
+	cout << "\tTest 14: Test integer keys." << endl;
+	cout << "\tTest 15: Test legacy header pages." << endl;
+	cout << "\tTest 16: Test index page right-links." << endl;
+	cout << "\tTest 17: Test scan descent." << endl;
+	cout << "\tTest 18: Test pin failures." << endl;
 	cout << "print"<<endl;
 	cout << "quit (not required)"<<endl;
 	cout << "Note that (<low>==-1)=>min and (<high>==-1)=>max"<<endl;